@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -36,7 +36,26 @@ SOURCES += \
     nodegene.cpp \
     genome.cpp \
     species.cpp \
-    controller.cpp
+    controller.cpp \
+    track.cpp \
+    options.cpp \
+    geometry.cpp \
+    world.cpp \
+    threadpool.cpp \
+    evaluator.cpp \
+    worker.cpp \
+    workerpool.cpp \
+    network.cpp \
+    vecenv.cpp \
+    benchmark.cpp \
+    screening.cpp \
+    fitnesscache.cpp \
+    steadystate.cpp \
+    island.cpp \
+    checkpoint.cpp \
+    codegen.cpp \
+    tape.cpp \
+    sprites.cpp
 
 HEADERS += \
     game.h \
@@ -49,7 +68,33 @@ HEADERS += \
     nodegene.h \
     genome.h \
     species.h \
-    controller.h
+    controller.h \
+    track.h \
+    options.h \
+    geometry.h \
+    world.h \
+    threadpool.h \
+    evaluator.h \
+    worker.h \
+    workerpool.h \
+    network.h \
+    vecenv.h \
+    benchmark.h \
+    screening.h \
+    fitnesscache.h \
+    steadystate.h \
+    migration.h \
+    island.h \
+    checkpoint.h \
+    codegen.h \
+    tape.h \
+    sprites.h
+
+# a network generated by --export-cpp is built in for --benchmark-codegen
+exists(champion.generated.h) {
+    DEFINES += GENERATED_CHAMPION
+    HEADERS += champion.generated.h
+}
 
 FORMS +=
 
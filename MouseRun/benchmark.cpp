@@ -0,0 +1,130 @@
+#include "benchmark.h"
+#include "vecenv.h"
+#include "threadpool.h"
+
+#include <memory>
+#include <random>
+#include <QElapsedTimer>
+#include <QDebug>
+
+const size_t benchmarkMice = 100;
+const long long benchmarkSteps = 2000;
+
+int benchmarkEnv(const Options &options)
+{
+    ThreadPool pool(options.threads);
+    VecEnv env(options.benchmarkWorlds, benchmarkMice, &pool);
+
+    std::vector<unsigned> seeds;
+    for(int k = 0; k < options.benchmarkWorlds; k++) {
+        seeds.push_back(options.trackSeed(k));
+    }
+
+    std::mt19937 gen(options.seed);
+    std::uniform_int_distribution<> dist(0, 15);
+    std::vector<unsigned char> actions(env.size());
+
+    long long mouseSteps = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    env.reset(seeds);
+    for(long long s = 0; s < benchmarkSteps; s++) {
+        if(env.finished()) {
+            env.reset(seeds);
+        }
+
+        for(size_t i = 0; i < env.size(); i++) {
+            actions[i] = env.dones()[i] ? 0 : dist(gen);
+            mouseSteps += !env.dones()[i];
+        }
+        env.step(actions.data());
+    }
+
+    double seconds = timer.nsecsElapsed() / 1e9;
+    qDebug() << "Worlds:" << env.numWorlds() << "Mice per world:" << env.micePerWorld()
+             << "Threads:" << pool.size();
+    qDebug() << "Steps:" << benchmarkSteps << "in" << seconds << "s,"
+             << mouseSteps / seconds << "mouse steps/s";
+
+    return 0;
+}
+
+#ifdef GENERATED_CHAMPION
+#include "champion.generated.h"
+#include "genome.h"
+#include "network.h"
+
+const int codegenRows = 100000;
+
+int benchmarkCodegen(const Options &options)
+{
+    QDataStream in(QByteArray::fromRawData(reinterpret_cast<const char*>(champion::genome),
+                                           int(sizeof(champion::genome))));
+    in.setVersion(QDataStream::Qt_5_10);
+    std::unique_ptr<Genome> genome(Genome::read(in));
+    Network network(*genome);
+
+    // inputs in the range of the observations
+    std::mt19937 gen(options.seed);
+    std::uniform_real_distribution<> dist(-300, 300);
+    std::vector<double> inputs(size_t(codegenRows) * champion::numInputs);
+    for(auto&& x : inputs) {
+        x = dist(gen);
+    }
+
+    std::vector<double> fed(size_t(codegenRows) * champion::numOutputs);
+    std::vector<double> interpreted(fed.size());
+    std::vector<double> generated(fed.size());
+    std::vector<double> values(network.size());
+    // the rows are one episode for the recurrent connections of all three
+    std::vector<double> networkState(network.stateSize(), 0);
+    std::vector<double> generatedState(champion::stateSize, 0);
+    QElapsedTimer timer;
+
+    timer.start();
+    for(int r = 0; r < codegenRows; r++) {
+        std::vector<double> row(inputs.begin() + r * champion::numInputs,
+                                inputs.begin() + (r + 1) * champion::numInputs);
+        std::vector<double> out = genome->feedForward(row);
+        std::copy(out.begin(), out.end(), fed.begin() + r * champion::numOutputs);
+    }
+    double fedSeconds = timer.nsecsElapsed() / 1e9;
+
+    timer.restart();
+    for(int r = 0; r < codegenRows; r++) {
+        network.evaluate(inputs.data() + r * champion::numInputs,
+                         interpreted.data() + r * champion::numOutputs, values.data(), networkState.data());
+    }
+    double networkSeconds = timer.nsecsElapsed() / 1e9;
+
+    timer.restart();
+    for(int r = 0; r < codegenRows; r++) {
+        champion::evaluate(inputs.data() + r * champion::numInputs,
+                           generated.data() + r * champion::numOutputs, generatedState.data());
+    }
+    double generatedSeconds = timer.nsecsElapsed() / 1e9;
+
+    // outputs have to be identical, not only close
+    size_t mismatches = 0;
+    for(size_t i = 0; i < fed.size(); i++) {
+        mismatches += generated[i] != fed[i] || interpreted[i] != fed[i];
+    }
+
+    qDebug() << "Nodes:" << genome->nodes.size() << "Connections:" << genome->connections.size()
+             << "Evaluations:" << codegenRows;
+    qDebug() << "feedForward:" << fedSeconds / codegenRows * 1e9 << "ns,"
+             << "Network:" << networkSeconds / codegenRows * 1e9 << "ns,"
+             << "generated:" << generatedSeconds / codegenRows * 1e9 << "ns";
+    qDebug() << "Mismatching outputs:" << mismatches;
+
+    return mismatches == 0 ? 0 : 1;
+}
+#else
+int benchmarkCodegen(const Options &)
+{
+    qWarning() << "No generated network in this build, write champion.generated.h with"
+               << "--export-cpp and run qmake again";
+    return 1;
+}
+#endif
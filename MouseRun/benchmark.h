@@ -0,0 +1,14 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "options.h"
+
+// Steps options.benchmarkWorlds worlds of VecEnv with random actions
+// and prints how many mouse steps per second are simulated
+int benchmarkEnv(const Options &options);
+
+// Compares the network generated into champion.generated.h (MouseRun --export-cpp),
+// when the binary was built with it, with Genome::feedForward and Network on random inputs
+int benchmarkCodegen(const Options &options);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,133 @@
+#include "checkpoint.h"
+#include "genome.h"
+#include "network.h"
+#include "codegen.h"
+
+#include <memory>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+const quint32 Checkpoint::magic;
+const quint32 Checkpoint::version;
+const qint64 Checkpoint::championOffset;
+
+QByteArray Checkpoint::build(const Genome &champion, const QByteArray &state)
+{
+    QByteArray championData;
+    QDataStream championStream(&championData, QIODevice::WriteOnly);
+    champion.write(championStream);
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_10);
+    out << magic << version << quint64(championData.size());
+    out.writeRawData(championData.constData(), championData.size());
+    out.writeRawData(state.constData(), state.size());
+    return data;
+}
+
+bool Checkpoint::write(const QString &path, const QByteArray &data)
+{
+    // written to a temporary file and renamed, a crash never leaves a broken checkpoint
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Can't write checkpoint" << path << file.errorString();
+        return false;
+    }
+    file.write(data);
+    return file.commit();
+}
+
+// Checks the header, returns the size of the champion or -1
+static qint64 readHeader(const uchar *data, qint64 size)
+{
+    if(size < Checkpoint::championOffset) {
+        return -1;
+    }
+
+    QDataStream in(QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(Checkpoint::championOffset)));
+    in.setVersion(QDataStream::Qt_5_10);
+    quint32 magic, version;
+    quint64 championSize;
+    in >> magic >> version >> championSize;
+    if(magic != Checkpoint::magic || version != Checkpoint::version
+            || Checkpoint::championOffset + qint64(championSize) > size) {
+        return -1;
+    }
+    return qint64(championSize);
+}
+
+QByteArray Checkpoint::readState(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't open checkpoint" << path << file.errorString();
+        return QByteArray();
+    }
+
+    QByteArray data = file.readAll();
+    qint64 championSize = readHeader(reinterpret_cast<const uchar*>(data.constData()), data.size());
+    if(championSize < 0) {
+        qWarning() << path << "is not a checkpoint of version" << version;
+        return QByteArray();
+    }
+    return data.mid(int(championOffset + championSize));
+}
+
+Genome *Checkpoint::readChampion(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    // only the pages of the header and the champion are read
+    uchar *data = file.map(0, file.size());
+    if(!data) {
+        return nullptr;
+    }
+
+    Genome *champion = nullptr;
+    qint64 championSize = readHeader(data, file.size());
+    if(championSize >= 0) {
+        QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(data + championOffset),
+                                                 int(championSize));
+        QDataStream in(raw);
+        in.setVersion(QDataStream::Qt_5_10);
+        champion = Genome::read(in);
+    }
+
+    file.unmap(data);
+    return champion;
+}
+
+int exportCheckpoint(const Options &options)
+{
+    std::unique_ptr<Genome> champion(Checkpoint::readChampion(options.exportCheckpoint));
+    if(!champion) {
+        qWarning() << "No champion in checkpoint" << options.exportCheckpoint;
+        return 1;
+    }
+    if(champion->numInputs != World::numInputs) {
+        qWarning() << "The champion has" << champion->numInputs << "inputs, the sensors give"
+                   << World::numInputs << "- use the sensor options of its run";
+        return 1;
+    }
+    if(options.champion.isEmpty() && options.exportCpp.isEmpty()) {
+        qWarning() << "Nothing to export, use --champion or --export-cpp";
+        return 1;
+    }
+
+    bool written = true;
+    if(!options.champion.isEmpty()) {
+        written = Network(*champion).save(options.champion) && written;
+    }
+    if(!options.exportCpp.isEmpty()) {
+        written = CodeGenerator::write(*champion, "champion", options.exportCpp) && written;
+    }
+    qDebug() << "Champion of" << options.exportCheckpoint << "with fitness" << champion->fitness
+             << (written ? "exported" : "not exported");
+    return written ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+#include "options.h"
+
+class Genome;
+
+// Checkpoint file of an evolutionary run. Written with QDataStream in the Qt 5.10 encoding:
+//  magic, version, size of the champion, the champion (Genome::write), run state (Controller::saveState)
+// The champion starts at championOffset, so it can be read from a mapped file without the rest.
+class Checkpoint
+{
+public:
+    static const quint32 magic = 0x4d52434b;    // "MRCK"
+    static const quint32 version = 2;
+    static const qint64 championOffset = 16;
+
+    // Complete file with the given champion and state
+    static QByteArray build(const Genome &champion, const QByteArray &state);
+
+    // Replaces the file atomically, safe to call from any thread
+    static bool write(const QString &path, const QByteArray &data);
+
+    // Run state of a checkpoint file, empty if the file is missing or has another version
+    static QByteArray readState(const QString &path);
+
+    // Champion of a checkpoint file read from a memory map, nullptr on failure
+    static Genome *readChampion(const QString &path);
+};
+
+// Writes the champion of the checkpoint options.exportCheckpoint as a champion network
+// (options.champion) and as generated code (options.exportCpp), 0 on success.
+// The sensors must be those of the run, checkpoints don't record them.
+int exportCheckpoint(const Options &options);
+
+#endif // CHECKPOINT_H
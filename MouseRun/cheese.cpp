@@ -1,4 +1,5 @@
 #include "cheese.h"
+#include "sprites.h"
 #include <QPainter>
 #include <QRandomGenerator>
 
@@ -6,6 +7,7 @@
 Cheese::Cheese()
 {
     setZValue(1);
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 QRectF Cheese::boundingRect() const
@@ -23,5 +25,5 @@ QPainterPath Cheese::shape() const
 void Cheese::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 {
     painter->setRenderHint(QPainter::Antialiasing);
-    painter->drawPixmap(boundingRect().toRect(), QPixmap(":/img/cheese.png"));
+    painter->drawPixmap(boundingRect().toRect(), Sprites::cheese());
 }
@@ -0,0 +1,127 @@
+#include "codegen.h"
+#include "genome.h"
+#include "network.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QSaveFile>
+#include <QTextStream>
+#include <algorithm>
+
+// Exact decimal form of a weight, 17 digits round-trip every double
+static QString literal(double value)
+{
+    QString s = QString::number(value, 'g', 17);
+    if(!s.contains('.') && !s.contains('e') && !s.contains("inf") && !s.contains("nan")) {
+        s += ".0";
+    }
+    return s;
+}
+
+// Expression of NodeGene::activationFunction applied to the sum s
+static const char *activation(int kind)
+{
+    switch(kind) {
+    case NodeGene::Tanh:
+        return "std::tanh(s)";
+    case NodeGene::Relu:
+        return "s > 0 ? s : 0.0";
+    case NodeGene::Step:
+        return "s > 0 ? 1.0 : 0.0";
+    case NodeGene::Gaussian:
+        return "std::exp(-s * s)";
+    case NodeGene::Identity:
+        return "s";
+    default:
+        return "1 / (1 + std::exp(-4.9 * s))";
+    }
+}
+
+QByteArray CodeGenerator::generate(const Genome &genome, const QString &name)
+{
+    Network network(genome);
+
+    QByteArray serialized;
+    QDataStream stream(&serialized, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_10);
+    genome.write(stream);
+
+    QString guard = name.toUpper() + "_GENERATED_H";
+
+    QByteArray code;
+    QTextStream out(&code);
+    out << "// Generated by MouseRun --export-cpp, do not edit.\n"
+        << "// " << genome.nodes.size() << " nodes, " << network.edges.size() << " enabled connections.\n"
+        << "#ifndef " << guard << "\n"
+        << "#define " << guard << "\n\n"
+        << "#include <cmath>\n\n"
+        << "namespace " << name << " {\n\n"
+        << "constexpr int numInputs = " << network.inputs << ";\n"
+        << "constexpr int numOutputs = " << network.outputs << ";\n"
+        << "// outputs of nodes kept for recurrent connections, zeroed at the start of an episode\n"
+        << "constexpr int stateSize = " << network.stateSlots.size() << ";\n\n";
+
+    // an empty array isn't allowed, a network without edges still gets one unused weight
+    out << "constexpr double weights[" << std::max<size_t>(1, network.edges.size()) << "] = {\n";
+    for(size_t e = 0; e < network.edges.size(); e++) {
+        out << "    " << literal(network.edges[e].weight) << ",\n";
+    }
+    if(network.edges.empty()) {
+        out << "    0.0\n";
+    }
+    out << "};\n\n";
+
+    // the genome itself, so a benchmark can compare with Genome::feedForward
+    out << "// Genome::write of the genome\n"
+        << "constexpr unsigned char genome[" << serialized.size() << "] = {";
+    for(int i = 0; i < serialized.size(); i++) {
+        out << (i % 16 == 0 ? "\n    " : " ") << int(static_cast<unsigned char>(serialized[i])) << ",";
+    }
+    out << "\n};\n\n";
+
+    out << "inline void evaluate(const double *inputs, double *outputs, double *"
+        << (network.stateSlots.empty() ? "/*state*/" : "state") << ")\n"
+        << "{\n"
+        << "    double v[" << network.numValues << "];\n";
+    for(int i = 0; i < network.inputs; i++) {
+        out << "    v[" << i << "] = inputs[" << i << "];\n";
+    }
+    out << "    v[" << network.biasSlot << "] = 1;\n";
+
+    // one sum and one activation per node in activation order, sums in the order of Network::evaluate
+    out << "    double s;\n";
+    for(size_t i = 0; i < network.activated.size(); i++) {
+        out << "    s = 0.0";
+        for(int e = network.edgeStart[i]; e < network.edgeStart[i + 1]; e++) {
+            out << " + weights[" << e << "] * " << (e < network.forwardStart[i] ? "state[" : "v[")
+                << network.edges[e].from << "]";
+        }
+        out << ";\n"
+            << "    v[" << network.activated[i] << "] = " << activation(network.activations[i]) << ";\n";
+    }
+
+    for(size_t k = 0; k < network.stateSlots.size(); k++) {
+        out << "    state[" << k << "] = v[" << network.stateSlots[k] << "];\n";
+    }
+
+    for(int i = 0; i < network.outputs; i++) {
+        out << "    outputs[" << i << "] = v[" << network.outputSlots[i] << "];\n";
+    }
+    out << "}\n\n"
+        << "} // namespace " << name << "\n\n"
+        << "#endif // " << guard << "\n";
+    out.flush();
+
+    return code;
+}
+
+bool CodeGenerator::write(const Genome &genome, const QString &name, const QString &path)
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Can't write generated network" << path << file.errorString();
+        return false;
+    }
+    file.write(generate(genome, name));
+    return file.commit();
+}
@@ -0,0 +1,24 @@
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <QByteArray>
+#include <QString>
+
+class Genome;
+
+// Generates a C++ header with the network of a genome as a straight-line function.
+// The header defines namespace name with numInputs, numOutputs, stateSize, a constexpr
+// table of the weights, the serialized genome and
+//  inline void evaluate(const double *inputs, double *outputs, double *state)
+// which gives the same result as Genome::feedForward, the sums are added in the same order.
+// state holds the stateSize values of recurrent connections for one episode.
+class CodeGenerator
+{
+public:
+    static QByteArray generate(const Genome &genome, const QString &name);
+
+    // Writes the generated header, false on failure
+    static bool write(const Genome &genome, const QString &name, const QString &path);
+};
+
+#endif // CODEGEN_H
@@ -1,7 +1,7 @@
 #ifndef CONNECTIONGENE_H
 #define CONNECTIONGENE_H
 
-class NodeGene;
+#include "nodegene.h"
 
 class ConnectionGene
 {
@@ -10,6 +10,10 @@ public:
 
     void mutateWeight();
 
+    // Connection to a node of the same or a lower layer (or to itself), it carries
+    // the output of its node from the previous evaluation
+    bool isRecurrent() const;
+
 // better solution later...
 //private:
     NodeGene *inNode;
@@ -19,4 +23,9 @@ public:
     int innovationNumber;
 };
 
+inline bool ConnectionGene::isRecurrent() const
+{
+    return inNode->layer >= outNode->layer;
+}
+
 #endif // CONNECTIONGENE_H
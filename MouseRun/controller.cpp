@@ -1,27 +1,53 @@
 #include "controller.h"
 #include "game.h"
+#include "world.h"
+#include "steadystate.h"
+#include "checkpoint.h"
+#include "codegen.h"
+#include "network.h"
+#include "tape.h"
 #include <cmath>
-#include <QTime>
+#include <algorithm>
+#include <random>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QDebug>
 
 const int populationSize = 1500;
 const int batchSize = 100;
 
-// number of inputs and outputs for the genome (nn)
-const int numInputs = 12;
-const int numOutputs = 4;
+// innovation numbers available to one island
+const int islandIdRange = 1 << 24;
 
-Controller::Controller()
+Controller::Controller(const Options &options, int island, Migration *migration)
     : generationNum{0},
-      nextConnId{0},
-      nextNodeId{numInputs + numOutputs + 1},
+      nextConnId{island * islandIdRange},
+      nextNodeId{World::numInputs + World::numOutputs + 1 + island * islandIdRange},
       numGenomesDone{0},
-      numOfGenerations{999999999}
+      numOfGenerations{999999999},
+      options{options},
+      workerPool{nullptr},
+      fitnessCutoff{0},
+      screeningStage{false},
+      cacheSettings{0},
+      island{island},
+      migration{migration}
 {
+    if(!options.resume.isEmpty()) {
+        QElapsedTimer time;
+        time.start();
+        if(restoreState(Checkpoint::readState(checkpointPath(options.resume)))) {
+            qDebug() << "Resumed generation" << generationNum << "from" << checkpointPath(options.resume)
+                     << "in" << time.elapsed() << "ms";
+        } else {
+            qWarning() << "Can't resume from" << checkpointPath(options.resume) << "starting a new run";
+        }
+    }
+
     // create initial population
-    for(int i = 0; i < populationSize; i++) {
+    for(int i = int(population.size()); i < populationSize; i++) {
 
-        Genome *genome = new Genome(numInputs, numOutputs);
+        Genome *genome = new Genome(World::numInputs, World::numOutputs);
         population.push_back(genome);
 
         connect(genome, SIGNAL(nodeIdNeeded(Genome*, int)),
@@ -33,7 +59,49 @@ Controller::Controller()
                 Qt::DirectConnection);
     }
 
-    runGeneration(0);
+    if(options.workers > 0 && !options.steadyState) {
+        workerPool = new WorkerPool(options.workers, options, this);
+        connect(workerPool, SIGNAL(finished()),
+                this, SLOT(workersFinished()));
+        qDebug() << "Evaluation in" << options.workers << "worker processes";
+    } else if(options.headless) {
+        pool = std::make_unique<ThreadPool>(options.threads);
+        evaluator = std::make_unique<Evaluator>(*pool, options.worldSize,
+                                                options.precision, options.precisionCheck);
+        qDebug() << "Headless evaluation on" << pool->size() << "threads in"
+                 << Tape::precisionName(options.precision) << "precision";
+    }
+
+    if(!options.headless) {
+        // the game window shows one track
+        this->options.episodes = 1;
+    } else if(options.episodes > 1) {
+        qDebug() << "Episodes per genome:" << options.episodes;
+    }
+
+    if(options.steadyState) {
+        if(options.workers > 0) {
+            qWarning() << "Steady-state evolution runs in this process, worker processes are not used";
+        }
+        if(!pool) {
+            pool = std::make_unique<ThreadPool>(options.threads);
+        }
+        QTimer::singleShot(0, this, SLOT(runSteadyState()));
+        return;
+    }
+
+    if(options.headless && options.fitnessCache) {
+        cache = std::make_unique<FitnessCache>();
+    }
+
+    if(options.headless && options.screenTicks > 0) {
+        screening = std::make_unique<Screening>(options.screenTicks, options.screenFraction,
+                                                options.episodes);
+        qDebug() << "Screening:" << options.screenTicks << "ticks, full episode for"
+                 << options.screenFraction << "of every species";
+    }
+
+    startGeneration();
 }
 
 
@@ -56,14 +124,9 @@ void Controller::getConnId(Genome *genome, int fromNodeId, int toNodeId)
     genome->newConnectionId = mapConn[key];
 }
 
-void Controller::calculateFitness(size_t i, double score)
+void Controller::calculateFitness(size_t i, double score, int termination)
 {
-    population[i]->fitness = score;
-    qDebug() << "Brain: " << i
-             << "Fitness: " << population[i]->fitness
-             << "Synapses: " << population[i]->connections.size()
-             << "Neurons: " << population[i]->nodes.size()
-             << "Layers: " << population[i]->layers;
+    recordFitness(i, score, termination);
 
     numGenomesDone++;
     if(numGenomesDone == populationSize) {
@@ -74,21 +137,652 @@ void Controller::calculateFitness(size_t i, double score)
     }
 }
 
+void Controller::recordFitness(size_t i, double score, int termination)
+{
+    population[i]->fitness = score;
+    population[i]->trackSeed = track->seed();
+    population[i]->termination = termination;
+    qDebug() << "Brain: " << i
+             << "Fitness: " << population[i]->fitness
+             << "Synapses: " << population[i]->connections.size()
+             << "Neurons: " << population[i]->nodes.size()
+             << "Layers: " << population[i]->layers
+             << "Track: " << population[i]->trackSeed
+             << "End: " << World::terminationName(termination);
+}
+
+World::Limits Controller::limits() const
+{
+    World::Limits limits;
+    limits.idleTicks = options.idleTicks;
+    limits.tickBudget = options.tickBudget;
+    if(options.hopeless) {
+        limits.cutoff = fitnessCutoff;
+    }
+    return limits;
+}
+
+void Controller::startGeneration()
+{
+    numGenomesDone = 0;
+
+    checkpoint();
+
+    // every batch of a generation runs on the same courses
+    tracks.clear();
+    for(int e = 0; e < options.episodes; e++) {
+        tracks.push_back(std::make_shared<const Track>(options.trackSeed(generationNum, e)));
+    }
+    track = tracks[0];
+
+    if(options.headless) {
+        prepareEvaluation();
+    }
+
+    if(workerPool && !evaluated.empty()) {
+        qDebug() << "Generation:" << generationNum << "Track:" << track->seed();
+        if(screening) {
+            screeningStage = true;
+            workerPool->evaluate(evaluated, {track->seed()}, screening->limits(limits()),
+                                 options.aggregation, batchSize);
+        } else {
+            workerPool->evaluate(evaluated, trackSeeds(), limits(), options.aggregation, batchSize);
+        }
+    } else if(options.headless) {
+        // return to the event loop first, evolve() would recurse otherwise
+        QTimer::singleShot(0, this, SLOT(evaluateGeneration()));
+    } else {
+        runGeneration(0);
+    }
+}
+
+void Controller::evaluateGeneration()
+{
+    qDebug() << "Generation:" << generationNum << "Track:" << track->seed();
+
+    QElapsedTimer time;
+    time.start();
+
+    // with worker processes this runs only if every genome was cached
+    std::vector<EpisodeResult> results;
+    if(evaluated.empty()) {
+        // nothing to simulate
+    } else if(screening) {
+        results = evaluator->evaluate(evaluated, track, screening->limits(limits()));
+
+        std::vector<Genome*> promoted;
+        for(size_t i : screening->promote(results, speciesGroups(evaluated))) {
+            promoted.push_back(evaluated[i]);
+        }
+        results = screening->merge(evaluator->evaluate(promoted, tracks, limits(), options.aggregation));
+    } else {
+        results = evaluator->evaluate(evaluated, tracks, limits(), options.aggregation);
+    }
+
+    qDebug() << "Generation:" << generationNum << "evaluated in" << time.elapsed() << "ms";
+
+    if(screening && !evaluated.empty()) {
+        reportScreening(results);
+    }
+    completeEvaluation(results);
+}
+
+void Controller::workersFinished()
+{
+    if(!screening) {
+        completeEvaluation(workerPool->results());
+        return;
+    }
+
+    if(screeningStage) {
+        screeningStage = false;
+
+        std::vector<Genome*> promoted;
+        for(size_t i : screening->promote(workerPool->results(), speciesGroups(evaluated))) {
+            promoted.push_back(evaluated[i]);
+        }
+        if(!promoted.empty()) {
+            workerPool->evaluate(promoted, trackSeeds(), limits(), options.aggregation, batchSize);
+            return;
+        }
+    }
+
+    std::vector<EpisodeResult> full;
+    if(!screening->promoted().empty()) {
+        full = workerPool->results();
+    }
+    std::vector<EpisodeResult> results = screening->merge(full);
+    reportScreening(results);
+    completeEvaluation(results);
+}
+
+void Controller::prepareEvaluation()
+{
+    evaluated.clear();
+    evaluatedHashes.clear();
+    evaluatedIndex.assign(population.size(), -1);
+    cachedResults.assign(population.size(), EpisodeResult{0, World::Running, 0});
+    if(cache) {
+        cacheSettings = FitnessCache::settingsHash(trackSeeds(), limits(), options.aggregation);
+    }
+
+    // first evaluated genome with the given hash
+    std::map<quint64, int> unique;
+
+    for(size_t i = 0; i < population.size(); i++) {
+        quint64 hash = cache ? population[i]->hash() : 0;
+
+        if(cache) {
+            if(cache->find(hash, cacheSettings, cachedResults[i])) {
+                continue;
+            }
+            auto search = unique.find(hash);
+            if(search != unique.end()) {
+                evaluatedIndex[i] = search->second;
+                continue;
+            }
+            unique[hash] = int(evaluated.size());
+        }
+
+        evaluatedIndex[i] = int(evaluated.size());
+        evaluated.push_back(population[i]);
+        evaluatedHashes.push_back(hash);
+    }
+}
+
+void Controller::completeEvaluation(const std::vector<EpisodeResult> &results)
+{
+    std::vector<EpisodeResult> all(population.size());
+    size_t hits = 0;
+    for(size_t i = 0; i < population.size(); i++) {
+        if(evaluatedIndex[i] < 0) {
+            all[i] = cachedResults[i];
+            hits++;
+        } else {
+            all[i] = results[evaluatedIndex[i]];
+        }
+    }
+
+    if(cache) {
+        for(size_t k = 0; k < evaluated.size(); k++) {
+            // extrapolated fitness of screened-out genomes depends on the rest of the generation
+            if(!screening || screening->isExact(k)) {
+                cache->insert(evaluatedHashes[k], cacheSettings, results[k]);
+            }
+        }
+
+        size_t duplicates = population.size() - hits - evaluated.size();
+        qDebug() << "Generation:" << generationNum
+                 << "Cache hits:" << hits << "Duplicates:" << duplicates
+                 << "Hit rate:" << double(hits + duplicates) / population.size()
+                 << "Entries:" << cache->size();
+        cache->nextGeneration();
+    }
+
+    finishGeneration(all);
+}
+
+void Controller::runSteadyState()
+{
+    qDebug() << "Steady-state evolution on" << pool->size() << "threads";
+
+    // a resumed run continues counting from the generation of its checkpoint
+    const int firstGeneration = generationNum;
+    SteadyState steadyState(*pool, options, population, species, [this](Genome *genome) {
+        adopt(genome);
+    }, [this, firstGeneration](long long generations) {
+        generationNum = firstGeneration + int(generations);
+        checkpoint();
+    });
+    steadyState.run((long long)(numOfGenerations - firstGeneration) * populationSize);
+}
+
+std::vector<unsigned> Controller::trackSeeds() const
+{
+    std::vector<unsigned> seeds;
+    for(auto&& t : tracks) {
+        seeds.push_back(t->seed());
+    }
+    return seeds;
+}
+
+std::vector<int> Controller::speciesGroups(const std::vector<Genome*> &genomes)
+{
+    std::vector<int> groups(genomes.size(), -1);
+    for(size_t i = 0; i < genomes.size(); i++) {
+        for(size_t j = 0; j < species.size(); j++) {
+            if(species[j]->isSameSpecies(*genomes[i])) {
+                groups[i] = int(j);
+                break;
+            }
+        }
+    }
+    return groups;
+}
+
+void Controller::reportScreening(const std::vector<EpisodeResult> &results)
+{
+    long long spent = screening->ticksSpent();
+    long long estimated = screening->ticksEstimated();
+    qDebug() << "Generation:" << generationNum
+             << "Screening promoted:" << screening->promoted().size() << "of" << results.size()
+             << "Ticks:" << spent << "Estimated full:" << estimated
+             << "Saved:" << estimated - spent;
+
+    // the full evaluation runs in this process only
+    if(!options.screenCheck || !evaluator) {
+        return;
+    }
+
+    std::vector<EpisodeResult> full = evaluator->evaluate(evaluated, tracks, limits(), options.aggregation);
+    std::vector<double> screened, exact;
+    long long fullTicks = 0;
+    for(size_t i = 0; i < results.size(); i++) {
+        screened.push_back(results[i].fitness);
+        exact.push_back(full[i].fitness);
+        fullTicks += full[i].ticks;
+    }
+    qDebug() << "Generation:" << generationNum
+             << "Full ticks:" << fullTicks
+             << "Rank correlation:" << Screening::rankCorrelation(screened, exact);
+}
+
+void Controller::reportTapes()
+{
+    size_t connections = 0, enabled = 0, activations = 0, edges = 0, optimizedActivations = 0, layered = 0;
+    std::vector<Tape> plain;
+    std::vector<std::shared_ptr<const Tape>> optimized;
+    size_t numValues = 0;
+    size_t stateSize = 0;
+    for(auto&& genome : population) {
+        plain.emplace_back(*genome, false);
+        optimized.push_back(genome->tape());
+        numValues = std::max(numValues, plain.back().size());
+        stateSize = std::max(stateSize, plain.back().stateSize());
+
+        connections += genome->connections.size();
+        enabled += plain.back().numEdges();
+        activations += plain.back().numActivations();
+        edges += optimized.back()->numEdges();
+        optimizedActivations += optimized.back()->numActivations();
+        layered += optimized.back()->isLayered();
+    }
+
+    // both versions see the same random observations
+    const int rows = 100;
+    std::mt19937 gen(generationNum);
+    std::uniform_real_distribution<> dist(-300, 300);
+    std::vector<double> inputs(rows * World::numInputs);
+    for(auto&& x : inputs) {
+        x = dist(gen);
+    }
+    std::vector<double> outputs(World::numOutputs);
+    std::vector<double> values(numValues);
+    std::vector<double> state(stateSize);
+
+    QElapsedTimer timer;
+    timer.start();
+    for(auto&& tape : plain) {
+        std::fill(state.begin(), state.end(), 0);
+        for(int r = 0; r < rows; r++) {
+            tape.evaluate(inputs.data() + r * World::numInputs, outputs.data(), values.data(), state.data());
+        }
+    }
+    qint64 plainTime = timer.nsecsElapsed();
+
+    timer.restart();
+    for(auto&& tape : optimized) {
+        std::fill(state.begin(), state.end(), 0);
+        for(int r = 0; r < rows; r++) {
+            tape->evaluate(inputs.data() + r * World::numInputs, outputs.data(), values.data(), state.data());
+        }
+    }
+    qint64 optimizedTime = timer.nsecsElapsed();
+
+    double evaluations = double(population.size()) * rows;
+    qDebug() << "Generation:" << generationNum
+             << "Connections:" << connections << "enabled:" << enabled << "optimized:" << edges
+             << "Nodes:" << activations << "optimized:" << optimizedActivations
+             << "Layered:" << layered
+             << "Evaluation:" << plainTime / evaluations << "ns optimized:" << optimizedTime / evaluations << "ns";
+}
+
+void Controller::finishGeneration(const std::vector<EpisodeResult> &results)
+{
+    // how many mice each rule stopped and how long the episodes were
+    std::vector<int> terminations(World::Budget + 1, 0);
+    long long ticks = 0;
+
+    for(size_t i = 0; i < population.size(); i++) {
+        recordFitness(i, results[i].fitness, results[i].termination);
+        terminations[results[i].termination]++;
+        ticks += results[i].ticks;
+    }
+
+    qDebug() << "Generation:" << generationNum << "Ticks:" << ticks
+             << "Caught:" << terminations[World::Caught]
+             << "Trapped:" << terminations[World::Trapped]
+             << "Idle:" << terminations[World::Idle]
+             << "Hopeless:" << terminations[World::Hopeless]
+             << "Budget:" << terminations[World::Budget];
+
+    if(options.tapeReport) {
+        reportTapes();
+    }
+
+    if(evaluator && options.precisionCheck) {
+        long long decisions, differing;
+        evaluator->takePrecisionCheck(decisions, differing);
+        qDebug() << "Generation:" << generationNum << "Decisions:" << decisions
+                 << "differing from double:" << differing
+                 << "(" << (decisions > 0 ? 100.0 * differing / decisions : 0) << "%)";
+    }
+
+    if(migration) {
+        qDebug() << "Island:" << island << "Generation:" << generationNum << "Best:"
+                 << (*std::max_element(population.begin(), population.end(),
+                                       [](const Genome *a, const Genome *b) { return a->fitness < b->fitness; }))->fitness;
+        migrate();
+    }
+
+    numGenomesDone = populationSize;
+    generationNum++;
+    evolve();
+}
+
+void Controller::migrate()
+{
+    if((generationNum + 1) % migration->interval != 0) {
+        return;
+    }
+
+    std::vector<Genome*> sorted = population;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Genome *a, const Genome *b) { return a->fitness > b->fitness; });
+
+    // the best genomes go to the next island
+    size_t numMigrants = std::min(sorted.size(), size_t(migration->migrants));
+    QByteArray message;
+    QDataStream out(&message, QIODevice::WriteOnly);
+    out << quint32(numMigrants);
+    for(size_t i = 0; i < numMigrants; i++) {
+        sorted[i]->write(out);
+    }
+    int next = (island + 1) % int(migration->inbox.size());
+    if(!migration->inbox[next]->push(message)) {
+        qDebug() << "Island:" << island << "inbox of island" << next << "is full, migrants dropped";
+    }
+
+    // received genomes replace the worst ones, they keep the fitness from their island
+    size_t replaced = 0;
+    QByteArray incoming;
+    while(migration->inbox[island]->pop(incoming)) {
+        QDataStream in(incoming);
+        quint32 count;
+        in >> count;
+        for(quint32 i = 0; i < count && replaced < sorted.size(); i++) {
+            Genome *immigrant = Genome::read(in);
+            adopt(immigrant);
+
+            Genome *worst = sorted[sorted.size() - 1 - replaced++];
+            *std::find(population.begin(), population.end(), worst) = immigrant;
+            // genomes of the current generation aren't in any species yet
+            delete worst;
+        }
+    }
+
+    if(replaced > 0) {
+        qDebug() << "Island:" << island << "Generation:" << generationNum << "Immigrants:" << replaced;
+    }
+}
+
+QString Controller::checkpointPath(const QString &path) const
+{
+    // every island has its own file
+    return migration ? QString("%1.%2").arg(path).arg(island) : path;
+}
+
+void Controller::checkpoint()
+{
+    if(options.checkpoint.isEmpty() || generationNum % options.checkpointInterval != 0) {
+        return;
+    }
+
+    // the champion is the best genome any species ever had
+    const Genome *champion = population[0];
+    for(auto&& s : species) {
+        if(s->representGenome->fitness > champion->fitness) {
+            champion = s->representGenome;
+        }
+    }
+
+    // serialized here, the genomes change once the generation runs
+    QByteArray data = Checkpoint::build(*champion, saveState());
+    QString path = checkpointPath(options.checkpoint);
+
+    if(pendingCheckpoint.valid() && !pendingCheckpoint.get()) {
+        qWarning() << "Previous checkpoint failed";
+    }
+    pendingCheckpoint = std::async(std::launch::async, [path, data]() {
+        return Checkpoint::write(path, data);
+    });
+    qDebug() << "Generation:" << generationNum << "Checkpoint:" << path << data.size() << "bytes";
+}
+
+void Controller::exportChampion()
+{
+    if(options.champion.isEmpty() && options.exportCpp.isEmpty()) {
+        return;
+    }
+
+    const Genome *best = *std::max_element(population.begin(), population.end(),
+                                           [](const Genome *a, const Genome *b) { return a->fitness < b->fitness; });
+    if(!options.champion.isEmpty()) {
+        Network(*best).save(checkpointPath(options.champion));
+    }
+    if(!options.exportCpp.isEmpty()) {
+        CodeGenerator::write(*best, "champion", checkpointPath(options.exportCpp));
+    }
+}
+
+QByteArray Controller::saveState() const
+{
+    QByteArray state;
+    QDataStream out(&state, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_10);
+
+    out << qint32(generationNum) << qint32(nextConnId) << qint32(nextNodeId)
+        << quint32(options.seed) << fitnessCutoff;
+
+    out << quint32(mapConn.size());
+    for(auto&& conn : mapConn) {
+        out << qint32(conn.first.first) << qint32(conn.first.second) << qint32(conn.second);
+    }
+    out << quint32(mapNode.size());
+    for(auto&& node : mapNode) {
+        out << qint32(node.first) << qint32(node.second);
+    }
+
+    // every genome once: the population, then members and representatives of species
+    std::vector<const Genome*> genomes;
+    std::map<const Genome*, quint32> indexOf;
+    auto add = [&](const Genome *genome) {
+        if(!indexOf.count(genome)) {
+            indexOf[genome] = quint32(genomes.size());
+            genomes.push_back(genome);
+        }
+    };
+    for(auto&& genome : population) {
+        add(genome);
+    }
+    for(auto&& s : species) {
+        add(s->representGenome);
+        for(auto&& genome : s->genomes) {
+            add(genome);
+        }
+    }
+
+    out << quint32(genomes.size());
+    for(auto&& genome : genomes) {
+        genome->write(out);
+    }
+
+    out << quint32(population.size());
+    for(auto&& genome : population) {
+        out << indexOf[genome];
+    }
+
+    out << quint32(species.size());
+    for(auto&& s : species) {
+        out << indexOf[s->representGenome] << s->bestFitness << s->averageFitness
+            << quint32(s->stagnantCoeff) << s->allowedReproduction;
+        out << quint32(s->genomes.size());
+        for(auto&& genome : s->genomes) {
+            out << indexOf[genome];
+        }
+    }
+
+    return state;
+}
+
+bool Controller::restoreState(const QByteArray &state)
+{
+    if(state.isEmpty()) {
+        return false;
+    }
+    QDataStream in(state);
+    in.setVersion(QDataStream::Qt_5_10);
+
+    qint32 generation, connId, nodeId;
+    quint32 seed;
+    double cutoff;
+    in >> generation >> connId >> nodeId >> seed >> cutoff;
+
+    std::map<std::pair<int, int>, int> conns;
+    std::map<int, int> nodes;
+    quint32 count;
+    in >> count;
+    for(quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        qint32 from, to, id;
+        in >> from >> to >> id;
+        conns[std::make_pair(from, to)] = id;
+    }
+    in >> count;
+    for(quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        qint32 connection, id;
+        in >> connection >> id;
+        nodes[connection] = id;
+    }
+
+    std::vector<Genome*> genomes;
+    in >> count;
+    for(quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        genomes.push_back(Genome::read(in));
+    }
+    auto genomeAt = [&](quint32 index) {
+        return index < genomes.size() ? genomes[index] : nullptr;
+    };
+
+    std::vector<Genome*> restoredPopulation;
+    in >> count;
+    for(quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        quint32 index;
+        in >> index;
+        if(genomeAt(index)) {
+            restoredPopulation.push_back(genomeAt(index));
+        }
+    }
+
+    std::vector<Species*> restoredSpecies;
+    in >> count;
+    for(quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        quint32 representative, stagnant, members;
+        double bestFitness, averageFitness;
+        bool allowedReproduction;
+        in >> representative >> bestFitness >> averageFitness >> stagnant >> allowedReproduction >> members;
+        if(!genomeAt(representative)) {
+            in.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        Species *s = new Species(genomeAt(representative));
+        s->genomes.clear();
+        for(quint32 j = 0; j < members; j++) {
+            quint32 index;
+            in >> index;
+            if(genomeAt(index)) {
+                s->genomes.push_back(genomeAt(index));
+            }
+        }
+        s->bestFitness = bestFitness;
+        s->averageFitness = averageFitness;
+        s->stagnantCoeff = stagnant;
+        s->allowedReproduction = allowedReproduction;
+        restoredSpecies.push_back(s);
+    }
+
+    // genomes of a run with other sensors can't be evaluated
+    bool sensorsMatch = std::all_of(genomes.begin(), genomes.end(),
+                                    [](const Genome *genome){ return genome->numInputs == World::numInputs; });
+    if(!sensorsMatch) {
+        qWarning() << "The checkpoint was written with other sensors than" << World::numInputs << "inputs";
+    }
+
+    if(in.status() != QDataStream::Ok || restoredPopulation.size() != size_t(populationSize) || !sensorsMatch) {
+        for(auto&& s : restoredSpecies) {
+            delete s;
+        }
+        for(auto&& genome : genomes) {
+            delete genome;
+        }
+        return false;
+    }
+
+    generationNum = generation;
+    nextConnId = connId;
+    nextNodeId = nodeId;
+    fitnessCutoff = cutoff;
+    mapConn = conns;
+    mapNode = nodes;
+    // tracks of the following generations are derived from the same seed
+    options.seed = seed;
+
+    population = restoredPopulation;
+    for(auto&& genome : population) {
+        adopt(genome);
+    }
+    species = restoredSpecies;
+    return true;
+}
+
+void Controller::adopt(Genome *genome)
+{
+    connect(genome, SIGNAL(nodeIdNeeded(Genome*, int)),
+            this, SLOT(getNodeId(Genome*, int)),
+            Qt::DirectConnection);
+
+    connect(genome, SIGNAL(connectionIdNeeded(Genome*, int, int)),
+            this, SLOT(getConnId(Genome*, int, int)),
+            Qt::DirectConnection);
+}
+
 void Controller::runGeneration(int bNum)
 {
-    qDebug() << "Generation:" << generationNum << "Batch:" << bNum;
+    qDebug() << "Generation:" << generationNum << "Batch:" << bNum << "Track:" << track->seed();
     // Calculate fitness as the time a player stays alive
     std::vector<Genome*> batch;
     for(size_t i = 0; i < batchSize; i++) {
         batch.push_back(population[bNum * batchSize + i]);
     }
-    Game *game = new Game(batch, bNum * batchSize);
-    connect(game, SIGNAL(died(size_t, double)),
-            this, SLOT(calculateFitness(size_t, double)));
+    Game *game = new Game(batch, bNum * batchSize, track, limits());
+    connect(game, SIGNAL(died(size_t, double, int)),
+            this, SLOT(calculateFitness(size_t, double, int)));
 }
 
 void Controller::evolve()
 {
+    exportChampion();
+
     // Speciate
     for(size_t i = 0; i < population.size(); i++) {
         bool newSpecies = true;
@@ -111,6 +805,7 @@ void Controller::evolve()
 
 
     double averageFitnessSum = 0;
+    fitnessCutoff = 0;
 
     for(size_t i = 0; i < species.size(); i++) {
 
@@ -120,7 +815,15 @@ void Controller::evolve()
             // maybe delete this species
         }
         species[i]->sortGenomesByFitness();
+        size_t sizeBefore = species[i]->genomes.size();
         species[i]->decimateSpecies();
+
+        // the weakest survivor of every decimated species, mice of the next generation
+        // that can't beat the lowest of them would be discarded by any species
+        if(species[i]->genomes.size() < sizeBefore) {
+            double kept = species[i]->genomes.back()->fitness;
+            fitnessCutoff = fitnessCutoff > 0 ? std::min(fitnessCutoff, kept) : kept;
+        }
         species[i]->calcAverageFitness();
         species[i]->explicitFitnessSharing();
         averageFitnessSum += species[i]->averageFitness;
@@ -175,7 +878,6 @@ void Controller::evolve()
     }
 
     if(--numOfGenerations > 0) {
-        numGenomesDone = 0;
-        runGeneration(0);
+        startGeneration();
     }
 }
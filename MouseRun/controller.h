@@ -3,7 +3,18 @@
 
 #include "species.h"
 #include "genome.h"
-
+#include "options.h"
+#include "track.h"
+#include "threadpool.h"
+#include "evaluator.h"
+#include "workerpool.h"
+#include "screening.h"
+#include "fitnesscache.h"
+#include "migration.h"
+#include "world.h"
+
+#include <future>
+#include <memory>
 #include <QObject>
 
 class Controller : public QObject
@@ -11,14 +22,26 @@ class Controller : public QObject
     Q_OBJECT
 
 public:
-    Controller();
+    // island and migration are used by the island model, every island numbers
+    // its innovations in its own range so genes of migrants never clash with local ones
+    Controller(const Options &options, int island = 0, Migration *migration = nullptr);
 
 public slots:
     void getNodeId(Genome* genome, int connectionId);
 
     void getConnId(Genome* genome, int fromNodeId, int toNodeId);
 
-    void calculateFitness(size_t i, double score);
+    void calculateFitness(size_t i, double score, int termination);
+
+private slots:
+    // Evaluates the whole generation in headless worlds
+    void evaluateGeneration();
+
+    // All batches were evaluated by the worker processes
+    void workersFinished();
+
+    // Steady-state evolution, runs instead of generations
+    void runSteadyState();
 
 private:
     // population of genetic algorithm
@@ -48,9 +71,92 @@ private:
 
     int numOfGenerations;
 
+    Options options;
+
+    // course of the current generation, shared by all of its batches
+    std::shared_ptr<const Track> track;
+
+    // tracks of all episodes of the current generation, the first one is track
+    std::vector<std::shared_ptr<const Track>> tracks;
+    std::vector<unsigned> trackSeeds() const;
+
+    // used only in headless mode
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<Evaluator> evaluator;
+
+    // used only with worker processes
+    WorkerPool *workerPool;
+
+    // lowest fitness kept by a decimated species in the last generation, 0 if none was
+    double fitnessCutoff;
+
+    // early termination rules for the current generation
+    World::Limits limits() const;
+
+    // used only with two-stage evaluation
+    std::unique_ptr<Screening> screening;
+    bool screeningStage;
+
+    // Index of the species every genome would join, -1 for a new one
+    std::vector<int> speciesGroups(const std::vector<Genome*> &genomes);
+
+    // used only in headless mode
+    std::unique_ptr<FitnessCache> cache;
+    quint64 cacheSettings;
+
+    // genomes of the population that have to be simulated, identical genomes run once
+    std::vector<Genome*> evaluated;
+    std::vector<quint64> evaluatedHashes;
+    // per genome of the population: index in evaluated, or -1 if its result was cached
+    std::vector<int> evaluatedIndex;
+    std::vector<EpisodeResult> cachedResults;
+
+    // Looks up the population in the cache and fills evaluated
+    void prepareEvaluation();
+
+    // results[k] belongs to evaluated[k], fills the cache and finishes the generation
+    void completeEvaluation(const std::vector<EpisodeResult> &results);
+
+    void reportScreening(const std::vector<EpisodeResult> &results);
+
+    // Sizes and evaluation time of the population's tapes with and without optimization
+    void reportTapes();
+
+    int island;
+    Migration *migration;
+
+    // Sends the best genomes to the next island and replaces the worst with received ones
+    void migrate();
+
+    // Connects the signals of a genome that didn't come from evolve()
+    void adopt(Genome *genome);
+
+    // Checkpoint written in the background, the next one waits for it
+    std::future<bool> pendingCheckpoint;
+
+    QString checkpointPath(const QString &path) const;
+
+    // Writes a checkpoint every checkpointInterval generations
+    void checkpoint();
+
+    // Writes the network of the best genome of the finished generation to the champion file
+    // and generates its C++ code
+    void exportChampion();
+
+    // Population, species, innovation maps and counters. Genomes are written once and
+    // referenced by index, species share them with the population.
+    QByteArray saveState() const;
+    bool restoreState(const QByteArray &state);
+
     void evolve();
 
+    void startGeneration();
+
     void runGeneration(int);
+
+    void recordFitness(size_t i, double score, int termination);
+
+    void finishGeneration(const std::vector<EpisodeResult> &results);
 };
 
 #endif // CONTROLLER_H
@@ -0,0 +1,151 @@
+#include "evaluator.h"
+
+Evaluator::Evaluator(ThreadPool &pool, size_t worldSize, Tape::Precision precision, bool checkPrecision)
+    : pool(pool),
+      worldSize{worldSize},
+      precision{precision},
+      check{checkPrecision && precision != Tape::Double ? new PrecisionCheck() : nullptr}
+{
+
+}
+
+void Evaluator::takePrecisionCheck(long long &decisions, long long &differing)
+{
+    decisions = check ? check->decisions.exchange(0) : 0;
+    differing = check ? check->differing.exchange(0) : 0;
+}
+
+std::vector<EpisodeResult> Evaluator::evaluate(const std::vector<Genome*> &genomes,
+                                               std::shared_ptr<const Track> track,
+                                               const World::Limits &limits)
+{
+    return evaluate(genomes, {track}, limits, Aggregation());
+}
+
+std::vector<EpisodeResult> Evaluator::evaluate(const std::vector<Genome*> &genomes,
+                                               const std::vector<std::shared_ptr<const Track>> &tracks,
+                                               const World::Limits &limits,
+                                               const Aggregation &aggregation)
+{
+    std::vector<std::shared_ptr<const Tape>> tapes;
+    for(auto&& genome : genomes) {
+        tapes.push_back(genome->tape());
+    }
+    return evaluate(tapes, tracks, limits, aggregation);
+}
+
+std::vector<EpisodeResult> Evaluator::evaluate(const std::vector<std::shared_ptr<const Tape>> &tapes,
+                                               const std::vector<std::shared_ptr<const Track>> &tracks,
+                                               const World::Limits &limits,
+                                               const Aggregation &aggregation)
+{
+    size_t n = tapes.size();
+    size_t numEpisodes = tracks.size();
+    size_t numWorlds = (n + worldSize - 1) / worldSize;
+
+    // results of episode e are at [e * n, (e + 1) * n)
+    std::vector<EpisodeResult> episodes(n * numEpisodes);
+
+    pool.parallelFor(numWorlds * numEpisodes, [&](size_t job) {
+        size_t e = job / numWorlds;
+        size_t first = (job % numWorlds) * worldSize;
+        size_t count = std::min(worldSize, n - first);
+        std::vector<const Tape*> worldTapes;
+        for(size_t i = first; i < first + count; i++) {
+            worldTapes.push_back(tapes[i].get());
+        }
+        runWorld(worldTapes.data(), count, tracks[e], limits, episodes.data() + e * n + first,
+                 precision, check.get());
+    });
+
+    if(numEpisodes == 1) {
+        return episodes;
+    }
+
+    std::vector<EpisodeResult> results(n);
+    std::vector<EpisodeResult> genomeEpisodes(numEpisodes);
+    for(size_t i = 0; i < n; i++) {
+        for(size_t e = 0; e < numEpisodes; e++) {
+            genomeEpisodes[e] = episodes[e * n + i];
+        }
+        results[i] = aggregation.combine(genomeEpisodes.data(), numEpisodes);
+    }
+    return results;
+}
+
+EpisodeResult Evaluator::evaluate(const Tape &tape,
+                                  const std::vector<std::shared_ptr<const Track>> &tracks,
+                                  const World::Limits &limits,
+                                  const Aggregation &aggregation,
+                                  Tape::Precision precision)
+{
+    std::vector<EpisodeResult> episodes(tracks.size());
+    const Tape *tapes[] = {&tape};
+    for(size_t e = 0; e < tracks.size(); e++) {
+        runWorld(tapes, 1, tracks[e], limits, &episodes[e], precision);
+    }
+    return aggregation.combine(episodes.data(), episodes.size());
+}
+
+void Evaluator::runWorld(const Tape *const *tapes, size_t n, std::shared_ptr<const Track> track,
+                         const World::Limits &limits, EpisodeResult *results,
+                         Tape::Precision precision, PrecisionCheck *check)
+{
+    World world(track, n, limits);
+
+    size_t numValues = 0;
+    size_t stateSize = 0;
+    for(size_t i = 0; i < n; i++) {
+        numValues = std::max(numValues, tapes[i]->size());
+        stateSize = std::max(stateSize, tapes[i]->stateSize());
+    }
+
+    std::vector<double> inputs(n * World::numInputs);
+    std::vector<double> outputs(World::numOutputs);
+    std::vector<double> values(numValues);
+    std::vector<float> reducedValues(precision == Tape::Double ? 0 : numValues);
+    // every mouse keeps the state of its recurrent connections for the whole episode,
+    // the reference of the precision check has its own
+    std::vector<double> states(precision == Tape::Double || check ? n * stateSize : 0, 0);
+    std::vector<float> reducedStates(precision == Tape::Double ? 0 : n * stateSize, 0);
+    std::vector<double> reference(World::numOutputs);
+    std::vector<unsigned char> actions(n, 0);
+    long long decisions = 0;
+    long long differing = 0;
+
+    while(!world.finished()) {
+        world.observe(inputs.data());
+
+        for(size_t i = 0; i < n; i++) {
+            if(!world.alive(i)) {
+                continue;
+            }
+            const double *observation = inputs.data() + i * World::numInputs;
+            if(precision == Tape::Double) {
+                tapes[i]->evaluate(observation, outputs.data(), values.data(), states.data() + i * stateSize);
+            } else {
+                tapes[i]->evaluate(observation, outputs.data(), reducedValues.data(),
+                                   reducedStates.data() + i * stateSize, precision);
+            }
+            actions[i] = World::decide(outputs.data());
+
+            // the mice follow the reduced precision, the reference only counts
+            if(check) {
+                tapes[i]->evaluate(observation, reference.data(), values.data(), states.data() + i * stateSize);
+                decisions++;
+                differing += World::decide(reference.data()) != actions[i];
+            }
+        }
+
+        world.step(actions.data());
+    }
+
+    for(size_t i = 0; i < n; i++) {
+        results[i] = world.result(i);
+    }
+
+    if(check) {
+        check->decisions += decisions;
+        check->differing += differing;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "genome.h"
+#include "tape.h"
+#include "threadpool.h"
+#include "track.h"
+#include "world.h"
+
+// Calculates fitness of genomes in headless worlds running on a thread pool
+class Evaluator
+{
+public:
+    // every world holds up to worldSize mice. Networks are evaluated with the given precision,
+    // checkPrecision also evaluates them in double precision and counts the ticks in which
+    // the pressed keys would differ.
+    Evaluator(ThreadPool &pool, size_t worldSize, Tape::Precision precision = Tape::Double,
+              bool checkPrecision = false);
+
+    // results[i] is the outcome of genomes[i] on the given track
+    std::vector<EpisodeResult> evaluate(const std::vector<Genome*> &genomes,
+                                        std::shared_ptr<const Track> track,
+                                        const World::Limits &limits = World::Limits());
+
+    // Every genome runs one episode on each track, all episodes in parallel.
+    // results[i] combines the episodes of genomes[i]. Tapes of the genomes are
+    // taken on the calling thread.
+    std::vector<EpisodeResult> evaluate(const std::vector<Genome*> &genomes,
+                                        const std::vector<std::shared_ptr<const Track>> &tracks,
+                                        const World::Limits &limits,
+                                        const Aggregation &aggregation);
+
+    // The same for networks already lowered to tapes, e.g. received by a worker
+    std::vector<EpisodeResult> evaluate(const std::vector<std::shared_ptr<const Tape>> &tapes,
+                                        const std::vector<std::shared_ptr<const Track>> &tracks,
+                                        const World::Limits &limits,
+                                        const Aggregation &aggregation);
+
+    // Runs one network alone on each track, safe to call from any thread
+    static EpisodeResult evaluate(const Tape &tape,
+                                  const std::vector<std::shared_ptr<const Track>> &tracks,
+                                  const World::Limits &limits,
+                                  const Aggregation &aggregation,
+                                  Tape::Precision precision = Tape::Double);
+
+    // Decisions compared with double precision since the last call and how many of them differed
+    void takePrecisionCheck(long long &decisions, long long &differing);
+
+private:
+    struct PrecisionCheck
+    {
+        std::atomic<long long> decisions{0};
+        std::atomic<long long> differing{0};
+    };
+
+    ThreadPool &pool;
+    size_t worldSize;
+    Tape::Precision precision;
+    std::unique_ptr<PrecisionCheck> check;
+
+    static void runWorld(const Tape *const *tapes, size_t n, std::shared_ptr<const Track> track,
+                         const World::Limits &limits, EpisodeResult *results,
+                         Tape::Precision precision = Tape::Double, PrecisionCheck *check = nullptr);
+};
+
+#endif // EVALUATOR_H
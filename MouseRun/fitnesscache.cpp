@@ -0,0 +1,67 @@
+#include "fitnesscache.h"
+
+#include <functional>
+
+FitnessCache::FitnessCache(int maxAge)
+    : generation{0},
+      maxAge{maxAge}
+{
+
+}
+
+bool FitnessCache::find(quint64 genomeHash, quint64 settings, EpisodeResult &result)
+{
+    auto search = entries.find(std::make_pair(genomeHash, settings));
+    if(search == entries.end()) {
+        return false;
+    }
+    search->second.lastUsed = generation;
+    result = search->second.result;
+    return true;
+}
+
+void FitnessCache::insert(quint64 genomeHash, quint64 settings, const EpisodeResult &result)
+{
+    Entry entry;
+    entry.result = result;
+    entry.lastUsed = generation;
+    entries[std::make_pair(genomeHash, settings)] = entry;
+}
+
+void FitnessCache::nextGeneration()
+{
+    generation++;
+    for(auto it = entries.begin(); it != entries.end(); ) {
+        if(generation - it->second.lastUsed > maxAge) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t FitnessCache::size() const
+{
+    return entries.size();
+}
+
+quint64 FitnessCache::settingsHash(const std::vector<unsigned> &trackSeeds,
+                                   const World::Limits &limits,
+                                   const Aggregation &aggregation)
+{
+    // boost::hash_combine
+    quint64 h = 0;
+    auto combine = [&h](quint64 value) {
+        h ^= value + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    };
+
+    for(unsigned seed : trackSeeds) {
+        combine(seed);
+    }
+    combine(quint64(limits.idleTicks));
+    combine(quint64(limits.tickBudget));
+    combine(std::hash<double>()(limits.cutoff));
+    combine(quint64(aggregation.kind));
+    combine(std::hash<double>()(aggregation.quantile));
+    return h;
+}
@@ -0,0 +1,43 @@
+#ifndef FITNESSCACHE_H
+#define FITNESSCACHE_H
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <QtGlobal>
+
+#include "world.h"
+
+// Results of evaluated genomes keyed by Genome::hash and a hash of everything else
+// the evaluation depends on (tracks, limits, aggregation). The simulation is
+// deterministic, so a genome found in the cache doesn't have to run again.
+class FitnessCache
+{
+public:
+    // entries not used for maxAge generations are dropped
+    explicit FitnessCache(int maxAge = 10);
+
+    bool find(quint64 genomeHash, quint64 settings, EpisodeResult &result);
+    void insert(quint64 genomeHash, quint64 settings, const EpisodeResult &result);
+
+    void nextGeneration();
+
+    size_t size() const;
+
+    static quint64 settingsHash(const std::vector<unsigned> &trackSeeds,
+                                const World::Limits &limits,
+                                const Aggregation &aggregation);
+
+private:
+    struct Entry
+    {
+        EpisodeResult result;
+        int lastUsed;
+    };
+
+    std::map<std::pair<quint64, quint64>, Entry> entries;
+    int generation;
+    int maxAge;
+};
+
+#endif // FITNESSCACHE_H
@@ -4,30 +4,66 @@
 #include "mousetrap.h"
 #include "waterpool.h"
 #include <QTimer>
+#include <QGraphicsEllipseItem>
+#include <QGraphicsLineItem>
+#include <QGraphicsPathItem>
+#include <algorithm>
+#include <unordered_map>
 #include <QDebug>
-#include <QRandomGenerator>
 
-const int areaH = 400;
+int Game::networkRefresh = 500;
+int Game::spectate = 0;
+bool Game::spectateDots = false;
+int Game::spectateFps = 10;
 
-Game::Game(std::vector<Genome*> genomes, unsigned bId)
+// Enabled connections are green for positive and red for negative weights, disabled ones blue
+static QColor connectionColor(const ConnectionGene *connection)
+{
+    if(!connection->enabled){
+        return QColor(0, 0, 255);
+    }
+    double w = qBound(-1.0, connection->weight, 1.0);
+    return w >= 0 ? QColor(0, int(w * 255), 0) : QColor(int(-w * 255), 0, 0);
+}
+
+Game::Game(std::vector<Genome*> genomes, unsigned bId, std::shared_ptr<const Track> track,
+           const World::Limits &limits)
     : bestI{0},
       bId{bId},
-      genomes{genomes}
+      genomes{genomes},
+      track{track},
+      world(track, genomes.size(), limits),
+      drawnAreas{0},
+      inputs(genomes.size() * World::numInputs),
+      outputs(World::numOutputs),
+      actions(genomes.size(), 0),
+      stateSize{0},
+      nnView{nullptr},
+      drawnGenome{nullptr},
+      drawnTopology{0},
+      dots{nullptr}
 {
-    numOfAlive = genomes.size();
-
-
-    // initialize players
+    // compile the networks and initialize players
+    size_t numValues = 0;
     for(size_t i = 0; i < genomes.size(); i++){
+        networks.emplace_back(*genomes[i]);
+        numValues = std::max(numValues, networks.back().size());
+        stateSize = std::max(stateSize, networks.back().stateSize());
+
         Player* player = new Player();
         mice.push_back(player);
+        drawn.push_back(i);
     }
+    values.resize(numValues);
+    states.assign(genomes.size() * stateSize, 0);
 
     // Create the scene
     int width = 600;
     int height = 800;
 
     scene = new QGraphicsScene(this);
+    // World finds the collisions, so the scene doesn't index items that move every tick
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
     setAlignment(Qt::AlignCenter);
 
     setFixedSize(width, height);
@@ -42,10 +78,12 @@ Game::Game(std::vector<Genome*> genomes, unsigned bId)
 
 
     // Window for nn
-    nnView = new QGraphicsView();
-    nnView->setScene(new QGraphicsScene(nnView));
-    nnView->setRenderHint(QPainter::Antialiasing);
-    nnView->move(600, 0);
+    if(networkRefresh > 0){
+        nnView = new QGraphicsView();
+        nnView->setScene(new QGraphicsScene(nnView));
+        nnView->setRenderHint(QPainter::Antialiasing);
+        nnView->move(600, 0);
+    }
     move(0,0);
     // Start the game
     start();
@@ -55,15 +93,14 @@ void Game::start()
 {
     // Spawn players
     for(size_t i = 0; i < mice.size(); i++){
-        mice[i]->setPos(QRandomGenerator::global()->bounded(-200,200)
-                        , -300);
+        mice[i]->setPos(world.mouseX(i), world.mouseY(i));
         scene->addItem(mice[i]);
 
     }
 
     // Spawn cat
     cat = new Cat();
-    cat->setPos(0, 0);
+    cat->setPos(0, world.catPosition());
     scene->addItem(cat);
 
     // Update the Game
@@ -71,6 +108,18 @@ void Game::start()
     connect(&updateTimer, SIGNAL(timeout()), this, SLOT(update()));
     updateTimer.start(15);
 
+    // spectators see only the leaders, at a lower frame rate than the simulation
+    if(spectate > 0){
+        if(spectateDots){
+            dots = scene->addPath(QPainterPath(), Qt::NoPen, QBrush(QColor(40, 40, 40)));
+            dots->setZValue(2);
+        }
+        QTimer *renderTimer = new QTimer(this);
+        connect(renderTimer, SIGNAL(timeout()), this, SLOT(render()));
+        renderTimer->start(1000 / std::max(1, spectateFps));
+        drawLeaders();
+    }
+
 
     // Setup left and right bound
     boundW = 500;
@@ -84,217 +133,162 @@ void Game::start()
     scene->addItem(rightBound);
 
 
-    // initialize item spawning
-//    spawnObjectsInArea(1);
-    spawnObjectsInArea(2);
-    spawnObjectsInArea(3);
-    spawnObjectsInArea(4);
-    bla = areaH;
-    areaNum = 4;
+    // draw the areas the world has already spawned
+    spawnObjects();
 
     // Show the scene
-    drawGenome(genomes[0]);
     show();
-    nnView->show();
-}
-
-double Game::distanceBetween(QGraphicsItem* a, QGraphicsItem* b){
-
-    double dx = a->pos().x() - b->pos().x();
-    double dy = a->pos().y() - b->pos().y();
-
-    return sqrt(dx*dx + dy*dy);
+    if(nnView){
+        drawGenome(genomes[0]);
+        nnView->show();
+    }
 }
 
 void Game::makeDecisions()
 {
-
     // make mice think
-    for(size_t i = 0; i < mice.size(); i++){
-        if(mice[i] != nullptr && mice[i]->alive){
-            // feed forward...
-            std::vector<double> inputs;
-
-            inputs.push_back(mice[i]->pos().x());
-            inputs.push_back(mice[i]->pos().y());
-
-            double rot = std::fmod(mice[i]->rotation(), 360);
-
-            if(rot > 180){
-                rot = -( 360 - rot);
-            }else if(rot < -180){
-                rot = 360 + rot;
-            }
-
-            inputs.push_back(rot);
-
-
-// INPUTS V3
-            QList<QGraphicsItem*> visibleFront = scene->items(mice[i]->mapRectToScene(mice[i]->fieldOfVisionForward()),
-                                                              Qt::IntersectsItemShape, Qt::AscendingOrder);
-            QList<QGraphicsItem*> visibleLeft = scene->items(mice[i]->mapRectToScene(mice[i]->fieldOfVisionLeft()),
-                                                             Qt::IntersectsItemShape, Qt::AscendingOrder);
-            QList<QGraphicsItem*> visibleRight = scene->items(mice[i]->mapRectToScene(mice[i]->fieldOfVisionRight()),
-                                                              Qt::IntersectsItemShape, Qt::AscendingOrder);
-
-            foreach (QGraphicsItem* item, visibleFront) {
-                if(Cheese* x = dynamic_cast<Cheese*>(item)) {
-//                  qDebug() << "CHEESE";
-                    inputs.push_back(100);
-                    mice[i]->advanceBonus++;
-                }
-                else if(MouseTrap* x = dynamic_cast<MouseTrap*>(item)) {
-//                  qDebug() << "TRAP";
-                    inputs.push_back(-100);
-                    mice[i]->advanceBonus--;
-                }
-                else if(WaterPool* x = dynamic_cast<WaterPool*>(item)) {
-//                  qDebug() << "POOL";
-                    inputs.push_back(-10);
-                    mice[i]->advanceBonus--;
-                }
-                else {
-                    continue;
-                }
-                inputs.push_back(item->pos().x());
-                inputs.push_back(item->pos().y());
-                break;
-            }
-            foreach (QGraphicsItem* item, visibleLeft) {
-                if(Cheese* x = dynamic_cast<Cheese*>(item)) {
-//                  qDebug() << "CHEESE";
-                    inputs.push_back(100);
-                }
-                else if(MouseTrap* x = dynamic_cast<MouseTrap*>(item)) {
-//                  qDebug() << "TRAP";
-                    inputs.push_back(-100);
-                    mice[i]->advanceBonus++;
-                }
-                else if(WaterPool* x = dynamic_cast<WaterPool*>(item)) {
-//                  qDebug() << "POOL";
-                    inputs.push_back(-10);
-                    mice[i]->advanceBonus++;
-                }
-                else {
-                    continue;
-                }
-                inputs.push_back(item->pos().x());
-                inputs.push_back(item->pos().y());
-                break;
-            }
+    world.observe(inputs.data());
 
-            foreach (QGraphicsItem* item, visibleRight) {
-                if(Cheese* x = dynamic_cast<Cheese*>(item)) {
-                    inputs.push_back(100);
-                }
-                else if(MouseTrap* x = dynamic_cast<MouseTrap*>(item)) {
-                    inputs.push_back(-100);
-                    mice[i]->advanceBonus++;
-                }
-                else if(WaterPool* x = dynamic_cast<WaterPool*>(item)) {
-                    inputs.push_back(-10);
-                    mice[i]->advanceBonus++;
-                }
-                else {
-                    continue;
-                }
-                inputs.push_back(item->pos().x());
-                inputs.push_back(item->pos().y());
-                break;
-            }
-
-
-            while(inputs.size() < 12){
-                inputs.push_back(0);
-            }
-
-//OUTPUTS
-
-
-            std::vector<double> outputs = genomes[i]->feedForward(inputs);
-            mice[i]->keysDown['w'] = outputs[0] >= 0.5;
-            mice[i]->keysDown['a'] = outputs[1] >= 0.5;
-            mice[i]->keysDown['s'] = outputs[2] >= 0.5;
-            mice[i]->keysDown['d'] = outputs[3] >= 0.5;
-        }
+    for(size_t k = 0; k < world.numAlive(); k++){
+        int i = world.aliveMouse(k);
+        networks[i].evaluate(inputs.data() + i * World::numInputs, outputs.data(), values.data(),
+                             states.data() + i * stateSize);
+        actions[i] = World::decide(outputs.data());
     }
 }
 
 void Game::update()
 {
-    // check for dead mice, determine best mouse
-    for(size_t i = 0; i < mice.size(); i++){
-
-        if(!mice[i]) { continue; }
+    if(world.finished()){
+        return;
+    }
 
-        if(mice[i]->pos().y() >= cat->pos().y()){
-            mice[i]->alive = false;
+    makeDecisions();
+    world.step(actions.data());
+
+    // A player died
+    for(size_t k = 0; k < drawn.size(); ){
+        int i = drawn[k];
+        if(world.alive(i)){
+            k++;
+            continue;
         }
 
-        if (!mice[i]->alive){
-            // A player died
-
-            // fitness function
-            double fitness = mice[i]->calcFitness();
-            emit died(bId + i, fitness);
-            delete mice[i];
-            mice[i] = nullptr;
-            numOfAlive--;
-        }else{
-
-            if(!mice[bestI] || mice[i]->pos().y() < mice[bestI]->pos().y()){
-                bestI = i;
-                drawGenome(genomes[bestI]);
+        emit died(bId + i, world.fitness(i), world.result(i).termination);
+        delete mice[i];
+        mice[i] = nullptr;
+        drawn[k] = drawn.back();
+        drawn.pop_back();
+    }
 
-            }
+    if(world.finished()){
+        delete nnView;
+        deleteLater();
+        return;
+    }
 
-            double p = mice[bestI]->pos().y();
-            if (leftBound->pos().y() > p + 600) {
-                leftBound->setPos(leftBound->pos().x(), p);
-                rightBound->setPos(rightBound->pos().x(), p);
-            }
+    // the camera follows the best mouse
+    size_t best = world.aliveMouse(0);
+    for(size_t k = 0; k < world.numAlive(); k++){
+        int i = world.aliveMouse(k);
+        if(world.mouseY(i) < world.mouseY(best)){
+            best = i;
         }
     }
+    bestI = best;
 
-    if(numOfAlive == 0){
-        delete nnView;
-        deleteLater();
+    // spectators are drawn by their own timer
+    if(spectate == 0){
+        render();
+    }
+}
+
+void Game::render()
+{
+    if(world.finished()){
         return;
     }
 
-    if(!mice[bestI]){
-        for(size_t i = 0; i < mice.size(); i++){
-            if(mice[i]){
-                bestI = i;
-                break;
-            }
+    if(spectate > 0){
+        drawLeaders();
+    }else{
+        for(size_t k = 0; k < world.numAlive(); k++){
+            int i = world.aliveMouse(k);
+            mice[i]->setPos(world.mouseX(i), world.mouseY(i));
+            mice[i]->setRotation(world.heading(i));
         }
     }
 
-    // Move the cat == move everything else
-    foreach (QGraphicsItem* item, scene->items()) {
-        if(Cat *cat = dynamic_cast<Cat*>(item)) continue;
-        if(WaterBound *b = dynamic_cast<WaterBound*>(item)) continue;
-        item->setPos(item->pos().x(), item->pos().y() + cat->speed);
+    // the network of the best mouse is shown at most once per networkRefresh
+    if(nnView && drawnGenome != genomes[bestI] && sinceDrawn.elapsed() >= networkRefresh){
+        drawGenome(genomes[bestI]);
+    }
+
+    double p = world.mouseY(bestI);
+    if (leftBound->pos().y() > p + 600) {
+        leftBound->setPos(leftBound->pos().x(), p);
+        rightBound->setPos(rightBound->pos().x(), p);
     }
 
+    // the cat chases the mice
+    cat->setPos(0, world.catPosition());
 
-    // run game normaly
     spawnObjects();
     focusBest();
     deleteObjects();
-    makeDecisions();
+}
+
+void Game::drawLeaders()
+{
+    // the mice furthest ahead are drawn, the others are hidden or only dots
+    std::vector<int> order(world.numAlive());
+    for(size_t k = 0; k < order.size(); k++){
+        order[k] = world.aliveMouse(k);
+    }
+    size_t leaders = std::min(size_t(spectate), order.size());
+    std::partial_sort(order.begin(), order.begin() + leaders, order.end(),
+                      [this](int a, int b){ return world.mouseY(a) < world.mouseY(b); });
+
+    QPainterPath path;
+    for(size_t k = 0; k < order.size(); k++){
+        int i = order[k];
+        mice[i]->setVisible(k < leaders);
+        if(k < leaders){
+            mice[i]->setPos(world.mouseX(i), world.mouseY(i));
+            mice[i]->setRotation(world.heading(i));
+        }else if(dots){
+            path.addEllipse(QPointF(world.mouseX(i), world.mouseY(i)), 3, 3);
+        }
+    }
+    if(dots){
+        dots->setPath(path);
+    }
 }
 
 void Game::focusBest(){
 
     // sceneWidth = 600, sceneHeight = 800
-    setSceneRect(-300, mice[bestI]->y() - 400, 600, 800);
+    setSceneRect(-300, world.mouseY(bestI) - 400, 600, 800);
 }
 
 void Game::drawGenome(Genome *gen)
 {
+    drawnGenome = gen;
+    sinceDrawn.start();
+
+    quint64 topology = gen->topologyHash();
+    if(topology == drawnTopology && edgeItems.size() == gen->connections.size()){
+        for(size_t i = 0; i < gen->connections.size(); i++){
+            QColor color = connectionColor(gen->connections[i]);
+            if(edgeItems[i]->pen().color() != color){
+                edgeItems[i]->setPen(QPen(color));
+            }
+        }
+        return;
+    }
 
+    drawnTopology = topology;
+    edgeItems.clear();
     nnView->scene()->clear();
 
     double d = 10;
@@ -302,55 +296,24 @@ void Game::drawGenome(Genome *gen)
     double offset = 3*d;
     double offsetL = 10*d;
 
-    std::map<int, std::pair<int, int>> nodes;
-    std::map<int, int> layers;
+    // nodes of a layer are stacked in a column
+    std::unordered_map<int, QPointF> nodes;
+    std::unordered_map<int, int> layers;
 
     for (size_t i = 0; i < gen->nodes.size(); i++){
-        QGraphicsEllipseItem* node = new QGraphicsEllipseItem(0, 0, d, d);
         int l = gen->nodes[i]->layer;
-        int id = gen->nodes[i]->id;
-
-        if(layers.count(l) == 0){
-            layers[l] = 1;
-        }else{
-            layers[l]++;
-        }
-        nodes[id] = std::make_pair(l * offsetL, layers[l] * offset);
+        QPointF pos(l * offsetL, ++layers[l] * offset);
+        nodes[gen->nodes[i]->id] = pos + QPointF(d/2, d/2);
 
-        node->setPos(nodes[id].first, nodes[id].second);
+        QGraphicsEllipseItem* node = new QGraphicsEllipseItem(0, 0, d, d);
+        node->setPos(pos);
         nnView->scene()->addItem(node);
     }
-    layers.clear();
 
     for(size_t i = 0; i < gen->connections.size(); i++){
-
-
-        int n1Id = gen->connections[i]->inNode->id;
-        int n2Id = gen->connections[i]->outNode->id;
-
-        double r = 0;
-        double g = 0;
-        double b = 0;
-
-
-        if(gen->connections[i]->enabled){
-
-            double w = gen->connections[i]->weight;
-            if(w >= 0){
-                g = w * 255;
-            }else{
-                r = -w * 255;
-            }
-        }else{
-            b = 255;
-        }
-
-
-        QColor color(r,g,b);
-        nnView->scene()->addLine(nodes[n1Id].first + d/2, nodes[n1Id].second + d/2,
-                                 nodes[n2Id].first + d/2, nodes[n2Id].second + d/2, QPen(color));
-
-
+        QPointF from = nodes[gen->connections[i]->inNode->id];
+        QPointF to = nodes[gen->connections[i]->outNode->id];
+        edgeItems.push_back(nnView->scene()->addLine(QLineF(from, to), QPen(connectionColor(gen->connections[i]))));
     }
 
     nnView->scene()->setSceneRect(nnView->scene()->itemsBoundingRect());
@@ -360,72 +323,46 @@ void Game::drawGenome(Genome *gen)
 void Game::spawnObjectsInArea(int area)
 {
     //spawn 2 mousetraps, 2 waterpools and 8 pieces of cheese
-    for(int i = 0; i < 12; i++) {
+    for(const TrackItem &trackItem : track->area(area)) {
 
         QGraphicsItem *item;
 
-        if (i < 2){
+        if (trackItem.kind == TrackItem::Trap){
             item = new MouseTrap();
 
-        } else if (i < 10){
+        } else if (trackItem.kind == TrackItem::Cheese){
             item = new Cheese();
 
         } else{
-            item = new WaterPool(QRandomGenerator::global()->bounded(30, 100),
-                                 QRandomGenerator::global()->bounded(30, 130));
+            item = new WaterPool(trackItem.height, trackItem.width);
         }
 
-        item->setRotation(QRandomGenerator::global()->bounded(-180, 180));
-        item->setPos(QRandomGenerator::global()->bounded(int(leftBound->pos().x() + boundW/2),
-                                                         int(rightBound->pos().x() - boundW/2)),
-                     - area * areaH + QRandomGenerator::global()->bounded(5, areaH - 5));
+        item->setRotation(trackItem.rotation);
+        item->setPos(trackItem.x, World::areaTop(area) + trackItem.offset);
 
         scene->addItem(item);
+        items.push_back(item);
     }
-
-//    QGraphicsLineItem* line = new QGraphicsLineItem(leftBound->pos().x() + boundW/2,
-//                                                    - area * areaH,
-//                                                    rightBound->pos().x() - boundW/2,
-//                                                    - area * areaH);
-//    scene->addItem(line);
 }
 
 void Game::spawnObjects()
 {
-
-    bla -= cat->speed;
-
-
-    double topY = 0;
-    for(size_t i=0; i<mice.size(); i++){
-        if(mice[i] && mice[i]->alive && mice[i]->pos().y() < topY){
-            topY = mice[i]->pos().y();
-        }
-    }
-
-    if(bla <= 0){
-        if(topY < (areaNum - 3) * (-areaH)){
-            spawnObjectsInArea(areaNum++);
-        }
-
-        spawnObjectsInArea(areaNum);
-        bla = areaH;
+    // draw the areas spawned by the world
+    while(drawnAreas < world.spawnedAreas()){
+        spawnObjectsInArea(drawnAreas++);
     }
 }
 
 void Game::deleteObjects()
 {
-    foreach (QGraphicsItem* item, scene->items()) {
-        if (item->pos().y() > cat->pos().y() + 500){
-            if (Cheese *cheese = dynamic_cast<Cheese*>(item)){
-                cheese->deleteLater();
-            }
-            else if (MouseTrap *trap = dynamic_cast<MouseTrap*>(item)){
-                trap->deleteLater();
-            }
-            else if (WaterPool *pool = dynamic_cast<WaterPool*>(item)){
-                pool->deleteLater();
-            }
+    // the same rule as in World, items far behind the cat are gone
+    for(auto it = items.begin(); it != items.end(); ){
+        if((*it)->pos().y() > world.catPosition() + 500){
+            scene->removeItem(*it);
+            delete *it;
+            it = items.erase(it);
+        }else{
+            ++it;
         }
     }
 }
@@ -2,31 +2,70 @@
 #define GAME_H
 
 #include <QGraphicsView>
+#include <QElapsedTimer>
+#include <deque>
+#include <memory>
 
 #include "player.h"
 #include "cat.h"
+#include "genome.h"
+#include "network.h"
+#include "track.h"
+#include "world.h"
 
+// Window showing a batch of genomes playing. The game is simulated by World,
+// the scene is in course coordinates and only follows the world's state.
 class Game : public QGraphicsView
 {
     Q_OBJECT
 
 public:
-    Game(std::vector<Genome*> genomes, unsigned bId);
+    Game(std::vector<Genome*> genomes, unsigned bId, std::shared_ptr<const Track> track,
+         const World::Limits &limits = World::Limits());
+
+    // Least time in ms between two redraws of the best mouse's network, 0 - no network window
+    static int networkRefresh;
+
+    // Spectator mode (0 - off): only the spectate mice furthest ahead are drawn, the others
+    // are dots with spectateDots, and the scene is redrawn spectateFps times per second.
+    // The simulation runs at the same speed and doesn't depend on what is drawn.
+    static int spectate;
+    static bool spectateDots;
+    static int spectateFps;
 
 signals:
-    void died(size_t i, double score);
+    void died(size_t i, double score, int termination);
 
 private:
 
     size_t bestI;
 
-    int i;
     unsigned bId;
     QGraphicsScene* scene;
-    std::vector<Player*> mice;
     std::vector<Genome*> genomes;
+    std::vector<Network> networks;
     Cat* cat;
 
+    // shared course, areas are drawn as the world spawns them
+    std::shared_ptr<const Track> track;
+    World world;
+    int drawnAreas;
+
+    // drawing of every mouse, indexed like genomes
+    std::vector<Player*> mice;
+    // mice that are still drawn
+    std::vector<int> drawn;
+
+    // buffers for the decisions of all mice
+    std::vector<double> inputs;
+    std::vector<double> outputs;
+    std::vector<double> values;
+    std::vector<unsigned char> actions;
+
+    // state of the recurrent connections of mouse i at i * stateSize
+    size_t stateSize;
+    std::vector<double> states;
+
     // Method that initializes the game
     void start();
 
@@ -35,26 +74,37 @@ private:
     QGraphicsItem *leftBound;
     QGraphicsItem *rightBound;
 
-    double bla;
-    int areaNum;
-
     qreal boundW;
-    int numOfAlive;
 
+    // items of the course in spawn order
+    std::deque<QGraphicsItem*> items;
+
+    // Draws the network of the genome into nnView. Items are created again only when the
+    // topology differs from the drawn network, otherwise only the colors of the edges change.
     void drawGenome(Genome* gen);
 
     QGraphicsView* nnView;
-    double distanceBetween(QGraphicsItem *a, QGraphicsItem *b);
-
+    Genome *drawnGenome;
+    quint64 drawnTopology;
+    std::vector<QGraphicsLineItem*> edgeItems;
+    QElapsedTimer sinceDrawn;
 
     void spawnObjects();
     void deleteObjects();
     void focusBest();
     void makeDecisions();
 
+    // Shows the spectate leaders and puts the dots of the other mice
+    void drawLeaders();
+    QGraphicsPathItem *dots;
+
 private slots:
+    // Simulates one tick, drawn right away unless in spectator mode
     void update();
 
+    // Moves the drawings to the state of the world
+    void render();
+
 };
 
 #endif // GAME_H
@@ -1,11 +1,16 @@
 #include "genome.h"
+#include "tape.h"
 
 #include <algorithm>
+#include <map>
 #include <random>
 #include <QDebug>
 
+double Genome::recurrentProb = 0;
+
 Genome::Genome(int inputs, int outputs)
-    : numInputs{inputs}, numOutputs{outputs}
+    : fitness{0}, trackSeed{0}, termination{0}, numInputs{inputs}, numOutputs{outputs},
+      compiledTopology{0}
 {
     // input and output layer at the beginning
     layers = 2;
@@ -26,6 +31,16 @@ Genome::Genome(int inputs, int outputs)
     nodes.push_back(new NodeGene(biasNodeId, 0));
 }
 
+Genome::~Genome()
+{
+    for(auto&& conn : connections) {
+        delete conn;
+    }
+    for(auto&& node : nodes) {
+        delete node;
+    }
+}
+
 std::vector<double> Genome::feedForward(std::vector<double> inputValues)
 {
     // set input values for input nodes
@@ -39,7 +54,14 @@ std::vector<double> Genome::feedForward(std::vector<double> inputValues)
     std::sort(sortedNodes.begin(), sortedNodes.end(),
               [](NodeGene *a, NodeGene *b){return a->layer < b->layer;});
 
-
+    // recurrent connections carry the outputs of the previous call, before any node changes
+    for(auto&& node : sortedNodes) {
+        for(auto&& conn : node->outputConnections) {
+            if(conn->enabled && conn->isRecurrent()) {
+                conn->outNode->inputSum += conn->weight * node->outputValue;
+            }
+        }
+    }
 
     for(auto&& node : sortedNodes) {
         node->activate();
@@ -70,6 +92,7 @@ void Genome::mutate()
     double weightsProb = 0.8;
     double connectionProb = 0.05;;
     double nodeProb = 0.03;
+    double activationProb = 0.03;
 
     if(r < weightsProb) {
         // Add connection if no connections exist
@@ -85,6 +108,8 @@ void Genome::mutate()
 
     } else if(r < weightsProb + connectionProb + nodeProb) {
         addNode();
+    } else if(r < weightsProb + connectionProb + nodeProb + activationProb) {
+        mutateActivation();
     }
     connectNodes();
 }
@@ -99,17 +124,20 @@ void Genome::addNode()
         addConnection();
         return;
     }
-    std::uniform_int_distribution<> dist(0, connections.size() - 1);
-    ConnectionGene *connection = connections[dist(gen)];
+    // pick a nonbias inNode, recurrent connections aren't split
+    std::vector<ConnectionGene*> candidates;
+    for(auto&& conn : connections) {
+        if(conn->inNode->id != biasNodeId && !conn->isRecurrent()) {
+            candidates.push_back(conn);
+        }
+    }
     // not disconnecting bias
-    if(connection->inNode->id == biasNodeId && connections.size() == 1) {
+    if(candidates.empty()) {
         addConnection();
         return;
     }
-    // pick a nonbias inNode
-    while(connection->inNode->id == biasNodeId) {
-        connection = connections[dist(gen)];
-    }
+    std::uniform_int_distribution<> dist(0, candidates.size() - 1);
+    ConnectionGene *connection = candidates[dist(gen)];
     // disable picked connection
     connection->enabled = false;
 
@@ -146,8 +174,70 @@ void Genome::addNode()
     connectNodes();
 }
 
+void Genome::mutateActivation()
+{
+    // inputs, outputs and the bias keep their functions
+    std::vector<NodeGene*> hidden;
+    for(auto&& node : nodes) {
+        if(node->id >= numInputs + numOutputs && node->id != biasNodeId) {
+            hidden.push_back(node);
+        }
+    }
+    if(hidden.empty()) {
+        return;
+    }
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> pick(0, hidden.size() - 1);
+    std::uniform_int_distribution<> other(1, NodeGene::NumActivations - 1);
+
+    NodeGene *node = hidden[pick(gen)];
+    node->activation = (node->activation + other(gen)) % NodeGene::NumActivations;
+}
+
+bool Genome::addRecurrentConnection()
+{
+    // any node but an input or the bias to a node of the same or a lower layer, or to itself
+    std::vector<std::pair<NodeGene*, NodeGene*>> candidates;
+    for(auto&& from : nodes) {
+        if(from->layer == 0) {
+            continue;
+        }
+        for(auto&& to : nodes) {
+            if(to->layer > 0 && from->layer >= to->layer && !from->isConnectedTo(to)) {
+                candidates.push_back({from, to});
+            }
+        }
+    }
+    if(candidates.empty()) {
+        return false;
+    }
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dist(0, candidates.size() - 1);
+    auto pair = candidates[dist(gen)];
+
+    emit connectionIdNeeded(this, pair.first->id, pair.second->id);
+    std::uniform_real_distribution<> distReal(-1, 1);
+    connections.push_back(new ConnectionGene(pair.first, pair.second, distReal(gen), newConnectionId));
+
+    connectNodes();
+    return true;
+}
+
 void Genome::addConnection()
 {
+    if(recurrentProb > 0) {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<> dist(0, 1);
+        if(dist(gen) < recurrentProb && addRecurrentConnection()) {
+            return;
+        }
+    }
+
     // Check if a new connection is possible
     bool possible = false;
     for(size_t i = 0; i < nodes.size(); i++){
@@ -201,9 +291,12 @@ Genome* Genome::crossover(Genome *other)
     child->layers = layers;
     child->biasNodeId = biasNodeId;
     // all nodes are inherited from more fit parent - this Genome
+    for(auto&& node : child->nodes) {
+        delete node;
+    }
     child->nodes.clear();
     for(size_t i = 0; i < nodes.size(); i++){
-        child->nodes.push_back(new NodeGene(nodes[i]->id, nodes[i]->layer));
+        child->nodes.push_back(new NodeGene(nodes[i]->id, nodes[i]->layer, nodes[i]->activation));
     }
 
     for(auto&& c1 : connections) {
@@ -211,9 +304,11 @@ Genome* Genome::crossover(Genome *other)
         NodeGene *childOutNode = nullptr;
 
         for(size_t z = 0; z < child->nodes.size(); z++){
+            // both ends are the same node in a self-loop
             if(child->nodes[z]->id == c1->inNode->id){
                 childInNode = child->nodes[z];
-            }else if(child->nodes[z]->id == c1->outNode->id){
+            }
+            if(child->nodes[z]->id == c1->outNode->id){
                 childOutNode = child->nodes[z];
             }
         }
@@ -267,6 +362,9 @@ Genome* Genome::crossover(Genome *other)
         }
     }
 
+    // every connection of the fitter parent is inherited
+    Q_ASSERT(child->connections.size() == connections.size());
+
     child->connectNodes();
 
     return child;
@@ -277,12 +375,17 @@ Genome *Genome::clone()
     Genome* genome = new Genome(numInputs, numOutputs);
 
 //    genome->nodes = nodes;
+    for(auto&& node : genome->nodes) {
+        delete node;
+    }
     genome->nodes.clear();
     for(size_t i = 0; i < nodes.size(); i++){
-        genome->nodes.push_back(new NodeGene(nodes[i]->id, nodes[i]->layer));
+        genome->nodes.push_back(new NodeGene(nodes[i]->id, nodes[i]->layer, nodes[i]->activation));
     }
     genome->layers = layers;
     genome->fitness = fitness;
+    genome->trackSeed = trackSeed;
+    genome->termination = termination;
     genome->newNodeId = newNodeId;
     genome->biasNodeId = biasNodeId;
     for(size_t i = 0; i < connections.size(); i++){
@@ -291,9 +394,11 @@ Genome *Genome::clone()
         NodeGene *cloneOutNode = nullptr;
 
         for(size_t z = 0; z < genome->nodes.size(); z++){
+            // both ends are the same node in a self-loop
             if(genome->nodes[z]->id == connections[i]->inNode->id){
                 cloneInNode = genome->nodes[z];
-            }else if(genome->nodes[z]->id == connections[i]->outNode->id){
+            }
+            if(genome->nodes[z]->id == connections[i]->outNode->id){
                 cloneOutNode = genome->nodes[z];
             }
         }
@@ -316,8 +421,15 @@ Genome *Genome::clone()
 
     genome->newConnectionId = newConnectionId;
 
+    // the clone must have the same network, its tape is shared below
+    Q_ASSERT(genome->connections.size() == connections.size());
+
     genome->connectNodes();
 
+    // the same network until one of them mutates
+    genome->compiledTape = compiledTape;
+    genome->compiledTopology = compiledTopology;
+
     return genome;
 }
 
@@ -331,3 +443,152 @@ void Genome::connectNodes()
         connections[i]->inNode->outputConnections.push_back(connections[i]);
     }
 }
+
+// FNV-1a
+static void hashBytes(quint64 &h, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+}
+
+template<typename T>
+static void hashValue(quint64 &h, T value)
+{
+    hashBytes(h, &value, sizeof(value));
+}
+
+quint64 Genome::hash() const
+{
+    quint64 h = 14695981039346656037ull;
+    hashValue(h, numInputs);
+    hashValue(h, numOutputs);
+    hashValue(h, biasNodeId);
+
+    hashValue(h, nodes.size());
+    for(auto&& node : nodes) {
+        hashValue(h, node->id);
+        hashValue(h, node->layer);
+        hashValue(h, node->activation);
+    }
+
+    hashValue(h, connections.size());
+    for(auto&& conn : connections) {
+        hashValue(h, conn->inNode->id);
+        hashValue(h, conn->outNode->id);
+        // +0.0 and -0.0 give the same outputs
+        hashValue(h, conn->weight == 0 ? 0.0 : conn->weight);
+        hashValue(h, conn->enabled);
+    }
+    return h;
+}
+
+quint64 Genome::topologyHash() const
+{
+    quint64 h = 14695981039346656037ull;
+    hashValue(h, numInputs);
+    hashValue(h, numOutputs);
+    hashValue(h, biasNodeId);
+
+    hashValue(h, nodes.size());
+    for(auto&& node : nodes) {
+        hashValue(h, node->id);
+        hashValue(h, node->layer);
+        hashValue(h, node->activation);
+    }
+
+    hashValue(h, connections.size());
+    for(auto&& conn : connections) {
+        hashValue(h, conn->inNode->id);
+        hashValue(h, conn->outNode->id);
+        hashValue(h, conn->enabled);
+    }
+    return h;
+}
+
+std::shared_ptr<const Tape> Genome::tape()
+{
+    quint64 topology = topologyHash();
+    if(!compiledTape || topology != compiledTopology) {
+        compiledTape = std::make_shared<Tape>(*this);
+        compiledTopology = topology;
+    } else if(!compiledTape->hasWeights(*this)) {
+        // copy on write, the old tape may still be used by a clone or an evaluation
+        if(compiledTape.use_count() > 1) {
+            compiledTape = std::make_shared<Tape>(*compiledTape);
+        }
+        compiledTape->updateWeights(*this);
+    }
+    return compiledTape;
+}
+
+void Genome::write(QDataStream &out) const
+{
+    out << qint32(numInputs) << qint32(numOutputs) << qint32(layers) << qint32(biasNodeId)
+        << fitness << quint32(trackSeed);
+
+    out << quint32(nodes.size());
+    for(auto&& node : nodes) {
+        out << qint32(node->id) << qint32(node->layer) << qint32(node->activation);
+    }
+
+    out << quint32(connections.size());
+    for(auto&& conn : connections) {
+        out << qint32(conn->inNode->id) << qint32(conn->outNode->id)
+            << conn->weight << conn->enabled << qint32(conn->innovationNumber);
+    }
+}
+
+Genome* Genome::read(QDataStream &in)
+{
+    qint32 inputs, outputs, layers, biasNodeId;
+    quint32 trackSeed;
+    double fitness;
+    in >> inputs >> outputs >> layers >> biasNodeId >> fitness >> trackSeed;
+
+    Genome *genome = new Genome(inputs, outputs);
+    genome->layers = layers;
+    genome->biasNodeId = biasNodeId;
+    genome->fitness = fitness;
+    genome->trackSeed = trackSeed;
+
+    quint32 numNodes;
+    in >> numNodes;
+    for(auto&& node : genome->nodes) {
+        delete node;
+    }
+    genome->nodes.clear();
+    std::map<int, NodeGene*> nodeById;
+    for(quint32 i = 0; i < numNodes && in.status() == QDataStream::Ok; i++) {
+        qint32 id, layer, activation;
+        in >> id >> layer >> activation;
+        if(activation < 0 || activation >= NodeGene::NumActivations) {
+            activation = NodeGene::Sigmoid; // corrupted data
+        }
+        NodeGene *node = new NodeGene(id, layer, activation);
+        genome->nodes.push_back(node);
+        nodeById[id] = node;
+    }
+
+    quint32 numConnections;
+    in >> numConnections;
+    for(quint32 i = 0; i < numConnections && in.status() == QDataStream::Ok; i++) {
+        qint32 inId, outId, innovationNumber;
+        double weight;
+        bool enabled;
+        in >> inId >> outId >> weight >> enabled >> innovationNumber;
+
+        if(!nodeById.count(inId) || !nodeById.count(outId)) {
+            continue; // corrupted data
+        }
+        ConnectionGene *conn = new ConnectionGene(nodeById[inId], nodeById[outId], weight, innovationNumber);
+        conn->enabled = enabled;
+        genome->connections.push_back(conn);
+    }
+
+    genome->connectNodes();
+
+    return genome;
+}
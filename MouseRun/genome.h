@@ -1,39 +1,69 @@
 #ifndef GENOME_H
 #define GENOME_H
 
+#include <memory>
 #include <vector>
 #include <QObject>
+#include <QDataStream>
 
 #include "nodegene.h"
 #include "connectiongene.h"
 
+class Tape;
+
 class Genome : public QObject
 {
     Q_OBJECT
 
 public:
     Genome(int input, int output);
+    ~Genome();
 
+    // Recurrent connections get the outputs of the previous call, which the nodes keep
     std::vector<double> feedForward(std::vector<double> inputValues);
 
     void mutate();
 
     void addNode();
 
+    // A random hidden node gets another activation function
+    void mutateActivation();
+
     void addConnection();
 
+    // Probability that addConnection adds a recurrent connection (--recurrent)
+    static double recurrentProb;
+
     Genome* crossover(Genome *other);
 
     Genome* clone();
 
     void connectNodes();
 
+    // Binary serialization of nodes and connections, used to send genomes to other processes
+    void write(QDataStream &out) const;
+    static Genome* read(QDataStream &in);
+
+    // Hash of the structure and weights. Genomes with equal hashes have the same network,
+    // nodes and connections are hashed in their order, which also fixes the order of summation.
+    quint64 hash() const;
+
+    // Hash of the nodes and connections without the weights
+    quint64 topologyHash() const;
+
+    // Instruction tape of the network. It is built on the first call and rebuilt only
+    // when the topology changed, otherwise only changed weights are copied into it.
+    // Clones share the tape until their weights change. Not thread-safe.
+    std::shared_ptr<const Tape> tape();
+
     int newNodeId;
     int newConnectionId;
 
     std::vector<NodeGene*> nodes;
     std::vector<ConnectionGene*> connections;
     double fitness;
+    unsigned trackSeed;     // track on which the fitness was calculated
+    int termination;        // World::Termination of that episode
     int numInputs;
     int numOutputs;
     int layers;
@@ -44,6 +74,13 @@ signals:
 
     void nodeIdNeeded(Genome*, int connectionId);
 
+private:
+    // false if every possible recurrent connection exists already
+    bool addRecurrentConnection();
+
+    std::shared_ptr<Tape> compiledTape;
+    quint64 compiledTopology;
+
 };
 
 #endif // GENOME_H
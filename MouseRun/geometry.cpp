@@ -0,0 +1,143 @@
+#include "geometry.h"
+
+#include <cmath>
+#include <algorithm>
+
+static const double pi = 3.14159265358979323846;
+
+double Polygon::minX() const
+{
+    return *std::min_element(x, x + size);
+}
+
+double Polygon::maxX() const
+{
+    return *std::max_element(x, x + size);
+}
+
+double Polygon::minY() const
+{
+    return *std::min_element(y, y + size);
+}
+
+double Polygon::maxY() const
+{
+    return *std::max_element(y, y + size);
+}
+
+static void transform(Polygon &p, double px, double py, double rotation)
+{
+    double rad = rotation * pi / 180;
+    double c = std::cos(rad);
+    double s = std::sin(rad);
+
+    for(int i = 0; i < p.size; i++) {
+        double x = p.x[i];
+        double y = p.y[i];
+        p.x[i] = px + x * c - y * s;
+        p.y[i] = py + x * s + y * c;
+    }
+}
+
+Polygon rectangle(double left, double top, double width, double height,
+                  double px, double py, double rotation)
+{
+    Polygon p;
+    p.size = 4;
+    p.x[0] = left;          p.y[0] = top;
+    p.x[1] = left + width;  p.y[1] = top;
+    p.x[2] = left + width;  p.y[2] = top + height;
+    p.x[3] = left;          p.y[3] = top + height;
+
+    transform(p, px, py, rotation);
+    return p;
+}
+
+Polygon ellipse(double left, double top, double width, double height,
+                double px, double py, double rotation)
+{
+    Polygon p;
+    p.size = Polygon::maxSize;
+
+    double cx = left + width / 2;
+    double cy = top + height / 2;
+    for(int i = 0; i < p.size; i++) {
+        double t = 2 * pi * i / p.size;
+        p.x[i] = cx + width / 2 * std::cos(t);
+        p.y[i] = cy + height / 2 * std::sin(t);
+    }
+
+    transform(p, px, py, rotation);
+    return p;
+}
+
+// true if the edges of a separate the two polygons
+static bool separated(const Polygon &a, const Polygon &b)
+{
+    for(int i = 0; i < a.size; i++) {
+        int j = (i + 1) % a.size;
+        double nx = a.y[j] - a.y[i];
+        double ny = a.x[i] - a.x[j];
+
+        double minA = INFINITY, maxA = -INFINITY;
+        for(int k = 0; k < a.size; k++) {
+            double d = a.x[k] * nx + a.y[k] * ny;
+            minA = std::min(minA, d);
+            maxA = std::max(maxA, d);
+        }
+
+        double minB = INFINITY, maxB = -INFINITY;
+        for(int k = 0; k < b.size; k++) {
+            double d = b.x[k] * nx + b.y[k] * ny;
+            minB = std::min(minB, d);
+            maxB = std::max(maxB, d);
+        }
+
+        if(maxA < minB || maxB < minA) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool intersects(const Polygon &a, const Polygon &b)
+{
+    return !separated(a, b) && !separated(b, a);
+}
+
+double rayDistance(const Polygon &p, double x, double y, double dx, double dy, double maxDistance)
+{
+    // the interior is on the same side of every edge, which side depends on the winding
+    double area = 0;
+    for(int i = 0; i < p.size; i++) {
+        int j = (i + 1) % p.size;
+        area += p.x[i] * p.y[j] - p.x[j] * p.y[i];
+    }
+    double orientation = area >= 0 ? 1 : -1;
+
+    // the ray is clipped by the half-plane of every edge (Cyrus-Beck)
+    double enter = 0;
+    double exit = maxDistance;
+    for(int i = 0; i < p.size; i++) {
+        int j = (i + 1) % p.size;
+        double nx = (p.y[j] - p.y[i]) * orientation;
+        double ny = (p.x[i] - p.x[j]) * orientation;
+
+        // inside while t * denominator <= numerator
+        double numerator = nx * (p.x[i] - x) + ny * (p.y[i] - y);
+        double denominator = nx * dx + ny * dy;
+        if(denominator == 0) {
+            if(numerator < 0) {
+                return maxDistance;
+            }
+        } else if(denominator < 0) {
+            enter = std::max(enter, numerator / denominator);
+        } else {
+            exit = std::min(exit, numerator / denominator);
+        }
+        if(enter > exit) {
+            return maxDistance;
+        }
+    }
+    return enter;
+}
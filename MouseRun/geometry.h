@@ -0,0 +1,35 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+// Convex polygon used for collision detection in the headless simulation
+struct Polygon
+{
+    static const int maxSize = 16;
+
+    int size;
+    double x[maxSize];
+    double y[maxSize];
+
+    double minX() const;
+    double maxX() const;
+    double minY() const;
+    double maxY() const;
+};
+
+// Rectangle (left, top, width, height) in item coordinates, mapped to the parent
+// the same way QGraphicsItem does it - rotated clockwise by rotation degrees around (px, py)
+Polygon rectangle(double left, double top, double width, double height,
+                  double px, double py, double rotation);
+
+// Ellipse inscribed in the rectangle, approximated by a polygon with maxSize vertices
+Polygon ellipse(double left, double top, double width, double height,
+                double px, double py, double rotation);
+
+// Separating axis test
+bool intersects(const Polygon &a, const Polygon &b);
+
+// Distance along the ray from (x, y) in the unit direction (dx, dy) at which it enters
+// the polygon, 0 if it starts inside, maxDistance if it doesn't enter it before
+double rayDistance(const Polygon &p, double x, double y, double dx, double dy, double maxDistance);
+
+#endif // GEOMETRY_H
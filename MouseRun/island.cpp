@@ -0,0 +1,63 @@
+#include "island.h"
+#include "controller.h"
+
+#include <algorithm>
+#include <QDebug>
+#include <QThread>
+
+Island::Island(const Options &options, int index, Migration *migration)
+    : options{options},
+      index{index},
+      migration{migration},
+      controller{nullptr}
+{
+
+}
+
+Island::~Island()
+{
+    delete controller;
+}
+
+void Island::start()
+{
+    controller = new Controller(options, index, migration);
+}
+
+IslandModel::IslandModel(const Options &options, QObject *parent)
+    : QObject(parent),
+      migration(options.islands, options.migrationInterval, options.migrants)
+{
+    // cores are divided between the islands
+    Options islandOptions = options;
+    if(islandOptions.threads == 0) {
+        islandOptions.threads = std::max(1, QThread::idealThreadCount() / options.islands);
+    }
+    if(islandOptions.workers > 0) {
+        qWarning() << "Islands evaluate on their own threads, worker processes are not used";
+        islandOptions.workers = 0;
+    }
+
+    qDebug() << options.islands << "islands on" << islandOptions.threads << "threads each, migration of"
+             << options.migrants << "genomes every" << options.migrationInterval << "generations";
+
+    for(int i = 0; i < options.islands; i++) {
+        QThread *thread = new QThread(this);
+        Island *island = new Island(islandOptions, i, &migration);
+        island->moveToThread(thread);
+        connect(thread, SIGNAL(started()), island, SLOT(start()));
+
+        threads.push_back(thread);
+        islands.push_back(island);
+        thread->start();
+    }
+}
+
+IslandModel::~IslandModel()
+{
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i]->quit();
+        threads[i]->wait();
+        delete islands[i];
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+
+#include <vector>
+#include <QObject>
+
+#include "options.h"
+#include "migration.h"
+
+class Controller;
+class QThread;
+
+// One population of the island model, its controller is created and runs on the island's thread
+class Island : public QObject
+{
+    Q_OBJECT
+
+public:
+    Island(const Options &options, int index, Migration *migration);
+    ~Island();
+
+public slots:
+    void start();
+
+private:
+    Options options;
+    int index;
+    Migration *migration;
+    Controller *controller;
+};
+
+// Island model (--islands). Independent populations with their own species and innovation
+// numbers evolve on their own threads and exchange their best genomes over lock-free queues.
+class IslandModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IslandModel(const Options &options, QObject *parent = nullptr);
+    ~IslandModel();
+
+private:
+    Migration migration;
+    std::vector<QThread*> threads;
+    std::vector<Island*> islands;
+};
+
+#endif // ISLAND_H
@@ -2,12 +2,52 @@
 
 #include "game.h"
 #include "controller.h"
+#include "options.h"
+#include "worker.h"
+#include "benchmark.h"
+#include "island.h"
+#include "checkpoint.h"
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    // headless runs don't need a display
+    QScopedPointer<QCoreApplication> a(isHeadless(argc, argv)
+                                       ? new QCoreApplication(argc, argv)
+                                       : new QApplication(argc, argv));
 
-    Controller controller;
+    Options options = parseOptions(a->arguments());
 
-    return a.exec();
+    // settings of the whole process are set once, before any island thread starts
+    // and before the first genome or world is created
+    World::setSensors(options.sensors);
+    Genome::recurrentProb = options.recurrent;
+    Tape::wavefront = options.wavefront;
+    Game::networkRefresh = options.networkRefresh;
+    Game::spectate = options.spectate;
+    Game::spectateDots = options.spectateDots;
+    Game::spectateFps = options.spectateFps;
+
+    if(options.benchmarkWorlds > 0) {
+        return benchmarkEnv(options);
+    }
+    if(options.benchmarkCodegen) {
+        return benchmarkCodegen(options);
+    }
+    if(!options.exportCheckpoint.isEmpty()) {
+        return exportCheckpoint(options);
+    }
+
+    if(!options.workerServer.isEmpty()) {
+        Worker worker(options.workerServer, options.workerId, options);
+        return a->exec();
+    }
+
+    if(options.islands > 1) {
+        IslandModel islands(options);
+        return a->exec();
+    }
+
+    Controller controller(options);
+
+    return a->exec();
 }
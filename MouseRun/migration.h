@@ -0,0 +1,73 @@
+#ifndef MIGRATION_H
+#define MIGRATION_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QByteArray>
+
+// Lock-free ring buffer for one producer thread and one consumer thread
+template<typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+        : slots(capacity + 1),
+          head{0},
+          tail{0}
+    {
+
+    }
+
+    // false if the ring is full
+    bool push(T value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) % slots.size();
+        if(next == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        slots[t] = std::move(value);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // false if the ring is empty
+    bool pop(T &value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(slots[h]);
+        head.store((h + 1) % slots.size(), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    std::atomic<size_t> head;   // next slot to read, written by the consumer
+    std::atomic<size_t> tail;   // next slot to write, written by the producer
+};
+
+// Exchange of genomes between islands arranged in a ring. Island i sends its best
+// genomes to island i + 1 every interval generations. A message is a QByteArray
+// with the number of genomes followed by the genomes (Genome::write).
+struct Migration
+{
+    Migration(int numIslands, int interval, int migrants)
+        : interval{interval},
+          migrants{migrants}
+    {
+        for(int i = 0; i < numIslands; i++) {
+            inbox.push_back(std::make_unique<SpscRing<QByteArray>>(8));
+        }
+    }
+
+    // inbox[i] is written by island i - 1 and read by island i
+    std::vector<std::unique_ptr<SpscRing<QByteArray>>> inbox;
+    int interval;
+    int migrants;
+};
+
+#endif // MIGRATION_H
@@ -1,9 +1,11 @@
 #include "mousetrap.h"
+#include "sprites.h"
 #include <QPainter>
 
 
 MouseTrap::MouseTrap(){
     setZValue(0);
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 QRectF MouseTrap::boundingRect() const
@@ -21,5 +23,5 @@ QPainterPath MouseTrap::shape() const
 void MouseTrap::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 {
     painter->setRenderHint(QPainter::Antialiasing);
-    painter->drawPixmap(boundingRect().toRect(), QPixmap(":/img/mousetrap.png"));
+    painter->drawPixmap(boundingRect().toRect(), Sprites::mouseTrap());
 }
@@ -0,0 +1,274 @@
+#include "network.h"
+#include "genome.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+const quint32 Network::magic;
+const quint32 Network::version;
+
+Network::Network(const Genome &genome)
+    : sensorConfig{World::sensors()},
+      inputs{genome.numInputs},
+      outputs{genome.numOutputs},
+      biasSlot{genome.biasNodeId},
+      numValues{genome.nodes.size()}
+{
+    // values are indexed the same way as genome.nodes
+    std::map<const NodeGene*, int> slotOf;
+    for(size_t i = 0; i < genome.nodes.size(); i++) {
+        slotOf[genome.nodes[i]] = int(i);
+    }
+
+    // the same order as in Genome::feedForward, so the sums are added in the same order
+    std::vector<NodeGene*> sortedNodes = genome.nodes;
+    std::sort(sortedNodes.begin(), sortedNodes.end(),
+              [](NodeGene *a, NodeGene *b){return a->layer < b->layer;});
+
+    // recurrent edges first, as feedForward adds them before activating any node
+    std::map<const NodeGene*, std::vector<Edge>> recurrent;
+    std::map<const NodeGene*, std::vector<Edge>> incoming;
+    std::map<int, int> stateOf;
+    for(auto&& node : sortedNodes) {
+        for(auto&& conn : node->outputConnections) {
+            if(!conn->enabled) {
+                continue;
+            }
+            if(conn->isRecurrent()) {
+                int slot = slotOf[node];
+                if(!stateOf.count(slot)) {
+                    stateOf[slot] = int(stateSlots.size());
+                    stateSlots.push_back(slot);
+                }
+                recurrent[conn->outNode].push_back({stateOf[slot], conn->weight});
+            } else {
+                incoming[conn->outNode].push_back({slotOf[node], conn->weight});
+            }
+        }
+    }
+
+    edgeStart.push_back(0);
+    for(auto&& node : sortedNodes) {
+        // input layer has no inputSum
+        if(node->layer == 0) {
+            continue;
+        }
+        activated.push_back(slotOf[node]);
+        activations.push_back(node->activation);
+        const std::vector<Edge> &back = recurrent[node];
+        edges.insert(edges.end(), back.begin(), back.end());
+        forwardStart.push_back(int(edges.size()));
+        const std::vector<Edge> &in = incoming[node];
+        edges.insert(edges.end(), in.begin(), in.end());
+        edgeStart.push_back(int(edges.size()));
+    }
+
+    for(int i = inputs; i < inputs + outputs; i++) {
+        outputSlots.push_back(i);
+    }
+}
+
+int Network::numInputs() const
+{
+    return inputs;
+}
+
+int Network::numOutputs() const
+{
+    return outputs;
+}
+
+const Sensors &Network::sensors() const
+{
+    return sensorConfig;
+}
+
+size_t Network::size() const
+{
+    return numValues;
+}
+
+size_t Network::stateSize() const
+{
+    return stateSlots.size();
+}
+
+void Network::evaluate(const double *in, double *out, double *values, double *state) const
+{
+    std::copy(in, in + inputs, values);
+    values[biasSlot] = 1;
+
+    for(size_t i = 0; i < activated.size(); i++) {
+        double sum = 0;
+        int e = edgeStart[i];
+        for(; e < forwardStart[i]; e++) {
+            sum += edges[e].weight * state[edges[e].from];
+        }
+        for(; e < edgeStart[i + 1]; e++) {
+            sum += edges[e].weight * values[edges[e].from];
+        }
+        values[activated[i]] = NodeGene::activationFunction(activations[i], sum);
+    }
+
+    for(size_t k = 0; k < stateSlots.size(); k++) {
+        state[k] = values[stateSlots[k]];
+    }
+
+    for(int i = 0; i < outputs; i++) {
+        out[i] = values[outputSlots[i]];
+    }
+}
+
+void Network::evaluate(const double *in, double *out, size_t rows) const
+{
+    std::vector<double> values(numValues);
+    std::vector<double> state(stateSlots.size(), 0);
+    for(size_t r = 0; r < rows; r++) {
+        evaluate(in + r * inputs, out + r * outputs, values.data(), state.data());
+    }
+}
+
+void Network::write(QDataStream &out) const
+{
+    out << magic << version
+        << qint32(sensorConfig.encoding) << qint32(sensorConfig.rays)
+        << sensorConfig.fieldOfView << sensorConfig.range
+        << qint32(inputs) << qint32(outputs) << qint32(biasSlot) << quint32(numValues);
+
+    out << quint32(activated.size());
+    for(size_t i = 0; i < activated.size(); i++) {
+        out << qint32(activated[i]) << qint32(activations[i]) << qint32(forwardStart[i])
+            << qint32(edgeStart[i + 1]);
+    }
+
+    out << quint32(edges.size());
+    for(auto&& edge : edges) {
+        out << qint32(edge.from) << edge.weight;
+    }
+
+    out << quint32(outputSlots.size());
+    for(int slot : outputSlots) {
+        out << qint32(slot);
+    }
+
+    out << quint32(stateSlots.size());
+    for(int slot : stateSlots) {
+        out << qint32(slot);
+    }
+}
+
+Network *Network::read(QDataStream &in)
+{
+    quint32 fileMagic, fileVersion, numValues, numActivated, numEdges, numOutputSlots, numStateSlots;
+    qint32 encoding, rays, inputs, outputs, biasSlot;
+    in >> fileMagic >> fileVersion;
+    if(fileMagic != magic || fileVersion != version) {
+        return nullptr;
+    }
+    Sensors sensors;
+    in >> encoding >> rays >> sensors.fieldOfView >> sensors.range;
+    sensors.encoding = Sensors::Encoding(encoding);
+    sensors.rays = rays;
+    in >> inputs >> outputs >> biasSlot >> numValues;
+
+    Network *network = new Network();
+    network->sensorConfig = sensors;
+    network->inputs = inputs;
+    network->outputs = outputs;
+    network->biasSlot = biasSlot;
+    network->numValues = numValues;
+
+    // every index is checked, evaluate trusts the arrays
+    bool valid = encoding >= Sensors::Legacy && encoding <= Sensors::Egocentric && rays >= 1
+            && sensors.numInputs() == inputs && outputs >= 0 && biasSlot >= 0 && quint32(biasSlot) < numValues
+            && quint32(inputs) <= numValues;
+
+    in >> numActivated;
+    network->edgeStart.push_back(0);
+    for(quint32 i = 0; i < numActivated && in.status() == QDataStream::Ok; i++) {
+        qint32 slot, activation, forward, end;
+        in >> slot >> activation >> forward >> end;
+        valid = valid && slot >= 0 && quint32(slot) < numValues
+                && forward >= network->edgeStart.back() && end >= forward
+                && activation >= 0 && activation < NodeGene::NumActivations;
+        network->activated.push_back(slot);
+        network->activations.push_back(activation);
+        network->forwardStart.push_back(forward);
+        network->edgeStart.push_back(end);
+    }
+
+    in >> numEdges;
+    for(quint32 i = 0; i < numEdges && in.status() == QDataStream::Ok; i++) {
+        qint32 from;
+        double weight;
+        in >> from >> weight;
+        network->edges.push_back({from, weight});
+    }
+    valid = valid && network->edgeStart.back() == int(network->edges.size());
+
+    in >> numOutputSlots;
+    for(quint32 i = 0; i < numOutputSlots && in.status() == QDataStream::Ok; i++) {
+        qint32 slot;
+        in >> slot;
+        valid = valid && slot >= 0 && quint32(slot) < numValues;
+        network->outputSlots.push_back(slot);
+    }
+    valid = valid && network->outputSlots.size() == size_t(outputs);
+
+    in >> numStateSlots;
+    for(quint32 i = 0; i < numStateSlots && in.status() == QDataStream::Ok; i++) {
+        qint32 slot;
+        in >> slot;
+        valid = valid && slot >= 0 && quint32(slot) < numValues;
+        network->stateSlots.push_back(slot);
+    }
+
+    // edges are checked once the state is known, recurrent ones index it
+    for(size_t i = 0; valid && i < network->activated.size(); i++) {
+        for(int e = network->edgeStart[i]; e < network->edgeStart[i + 1]; e++) {
+            size_t limit = e < network->forwardStart[i] ? network->stateSlots.size() : numValues;
+            valid = valid && network->edges[e].from >= 0 && size_t(network->edges[e].from) < limit;
+        }
+    }
+
+    if(!valid || in.status() != QDataStream::Ok) {
+        delete network;
+        return nullptr;
+    }
+    return network;
+}
+
+bool Network::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Can't write champion" << path << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_10);
+    write(out);
+    return file.commit();
+}
+
+Network *Network::load(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't read champion" << path << file.errorString();
+        return nullptr;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_10);
+    Network *network = read(in);
+    if(!network) {
+        qWarning() << "Broken champion file" << path;
+    }
+    return network;
+}
@@ -0,0 +1,88 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QString>
+#include <QtGlobal>
+
+#include "world.h"
+
+class Genome;
+class QDataStream;
+
+// Flat phenotype of a genome. Nodes are stored in activation order with their
+// incoming connections in one contiguous array, so evaluation only reads the
+// network and one network can be used by many threads at the same time.
+class Network
+{
+public:
+    explicit Network(const Genome &genome);
+
+    int numInputs() const;
+    int numOutputs() const;
+
+    // Sensors of the world the network was compiled in, the inputs it expects
+    const Sensors &sensors() const;
+
+    // Number of values needed by evaluate
+    size_t size() const;
+
+    // Number of outputs of nodes kept for the recurrent connections of the next evaluation
+    size_t stateSize() const;
+
+    // Same result as Genome::feedForward. values is a scratch buffer of size() doubles,
+    // state the stateSize() doubles of one episode, zeroed at its start (may be nullptr
+    // if stateSize() is 0).
+    void evaluate(const double *inputs, double *outputs, double *values, double *state = nullptr) const;
+
+    // Evaluates rows networks inputs, one after another as one episode (numInputs and
+    // numOutputs values per row)
+    void evaluate(const double *inputs, double *outputs, size_t rows) const;
+
+    // Champion file: magic, version, sensors and the flat arrays, so a player doesn't need
+    // the genome or the options of the training run
+    static const quint32 magic = 0x4d524e4e;    // "MRNN"
+    static const quint32 version = 4;
+
+    void write(QDataStream &out) const;
+    static Network *read(QDataStream &in);
+
+    // Replaces the file atomically, false on failure
+    bool save(const QString &path) const;
+
+    // Network of a champion file, nullptr if the file is missing or broken
+    static Network *load(const QString &path);
+
+private:
+    friend class CodeGenerator;
+
+    Network() = default;
+
+    struct Edge
+    {
+        int from;       // index of the value, of the state for recurrent edges
+        double weight;
+    };
+
+    Sensors sensorConfig;
+    int inputs;
+    int outputs;
+    int biasSlot;
+    size_t numValues;
+
+    // value index and NodeGene::Activation of every activated node, edges of node i
+    // are [edgeStart[i], edgeStart[i + 1]), the recurrent ones before forwardStart[i]
+    std::vector<int> activated;
+    std::vector<int> activations;
+    std::vector<int> edgeStart;
+    std::vector<int> forwardStart;
+    std::vector<Edge> edges;
+    std::vector<int> outputSlots;
+
+    // value index saved in every state entry after the activations
+    std::vector<int> stateSlots;
+};
+
+#endif // NETWORK_H
@@ -4,8 +4,8 @@
 #include <cmath>
 #include <QDebug>
 
-NodeGene::NodeGene(int id, int layer)
-    : id{id}, layer{layer}, inputSum{0}, outputValue{0}
+NodeGene::NodeGene(int id, int layer, int activation)
+    : id{id}, layer{layer}, activation{activation}, inputSum{0}, outputValue{0}
 {
 
 }
@@ -18,8 +18,9 @@ void NodeGene::activate()
         outputValue = activationFunction(inputSum);
     }
 
+    // recurrent connections were added before the first node was activated
     for(size_t i = 0; i < outputConnections.size(); i++) {
-        if(outputConnections[i]->enabled){
+        if(outputConnections[i]->enabled && !outputConnections[i]->isRecurrent()){
             outputConnections[i]->outNode->inputSum += outputConnections[i]->weight * outputValue;
         }
     }
@@ -36,8 +37,13 @@ bool NodeGene::isConnectedTo(NodeGene *other)
     return false;
 }
 
-// modified sigmoidal function
 double NodeGene::activationFunction(double x)
 {
-    return 1 / (1 + std::exp(-4.9 * x));
+    return activationFunction(activation, x);
+}
+
+const char *NodeGene::activationName(int activation)
+{
+    static const char *names[] = {"sigmoid", "tanh", "relu", "step", "gaussian", "identity"};
+    return activation >= 0 && activation < NumActivations ? names[activation] : "unknown";
 }
@@ -1,6 +1,7 @@
 #ifndef NODEGENE_H
 #define NODEGENE_H
 
+#include <cmath>
 #include <vector>
 
 class ConnectionGene;
@@ -8,7 +9,10 @@ class ConnectionGene;
 class NodeGene
 {
 public:
-    NodeGene(int id, int layer);
+    // Activation functions of hidden nodes, new nodes start with the steepened sigmoid
+    enum Activation { Sigmoid, Tanh, Relu, Step, Gaussian, Identity, NumActivations };
+
+    NodeGene(int id, int layer, int activation = Sigmoid);
 
     void activate();
 
@@ -18,11 +22,38 @@ public:
 //private:
     int id;
     int layer;
+    int activation;
     double inputSum;
     double outputValue;
     std::vector<ConnectionGene*> outputConnections;
 
     double activationFunction(double x);
+
+    // The function of the given kind, shared by all compiled networks
+    template<typename T>
+    static T activationFunction(int activation, T x);
+
+    static const char *activationName(int activation);
 };
 
+template<typename T>
+inline T NodeGene::activationFunction(int activation, T x)
+{
+    switch(activation) {
+    case Tanh:
+        return std::tanh(x);
+    case Relu:
+        return x > 0 ? x : T(0);
+    case Step:
+        return x > 0 ? T(1) : T(0);
+    case Gaussian:
+        return std::exp(-x * x);
+    case Identity:
+        return x;
+    default:
+        // modified sigmoidal function
+        return 1 / (1 + std::exp(T(-4.9) * x));
+    }
+}
+
 #endif // NODEGENE_H
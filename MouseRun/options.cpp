@@ -0,0 +1,371 @@
+#include "options.h"
+#include "track.h"
+
+#include <algorithm>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QRandomGenerator>
+
+Options::Options()
+    : seed{QRandomGenerator::global()->generate()},
+      headless{false},
+      threads{0},
+      worldSize{10},
+      workers{0},
+      workerId{0},
+      idleTicks{0},
+      tickBudget{0},
+      hopeless{false},
+      screenTicks{0},
+      screenFraction{0.25},
+      screenCheck{false},
+      precision{Tape::Double},
+      precisionCheck{false},
+      wavefront{Tape::Auto},
+      networkRefresh{500},
+      spectate{0},
+      spectateDots{false},
+      spectateFps{10},
+      recurrent{0},
+      tapeReport{false},
+      benchmarkWorlds{0},
+      benchmarkCodegen{false},
+      islands{1},
+      migrationInterval{5},
+      migrants{5},
+      checkpointInterval{10},
+      steadyState{false},
+      fitnessCache{true},
+      episodes{1}
+{
+
+}
+
+unsigned Options::trackSeed(int generation, int episode) const
+{
+    if(!benchmarkSeeds.empty()) {
+        return benchmarkSeeds[(generation + episode) % benchmarkSeeds.size()];
+    }
+
+    // the first episode keeps the track it had with a single episode
+    unsigned generationSeed = Track::deriveSeed(seed, generation);
+    return episode == 0 ? generationSeed : Track::deriveSeed(generationSeed, episode);
+}
+
+Options parseOptions(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+
+    QCommandLineOption seedOption("seed",
+                                  "Base seed of the tracks, random if not set.",
+                                  "seed");
+    QCommandLineOption benchmarkOption("benchmark-seeds",
+                                       "Comma separated list of track seeds, generations cycle through them.",
+                                       "seeds");
+    QCommandLineOption headlessOption("headless",
+                                      "Evaluate genomes without windows, in parallel.");
+    QCommandLineOption threadsOption("threads",
+                                     "Number of evaluation threads, one per core by default.",
+                                     "n");
+    QCommandLineOption worldSizeOption("world-size",
+                                       "Number of mice in one headless world (default 10).",
+                                       "n");
+    QCommandLineOption workersOption("workers",
+                                     "Evaluate batches in n local worker processes.",
+                                     "n");
+    QCommandLineOption workerOption("worker",
+                                    "Run as a worker of the coordinator listening on the given local server.",
+                                    "server");
+    QCommandLineOption workerIdOption("worker-id",
+                                      "Id of the worker, given by the coordinator.",
+                                      "id");
+    QCommandLineOption benchmarkEnvOption("benchmark-env",
+                                          "Measure the speed of k headless worlds stepped together and exit.",
+                                          "k");
+    QCommandLineOption benchmarkCodegenOption("benchmark-codegen",
+                                              "Compare the generated network built into the binary with Genome::feedForward and exit.");
+    QCommandLineOption precisionOption("precision",
+                                       "Precision of the networks in headless mode: double (default), float or int8.",
+                                       "precision");
+    QCommandLineOption precisionCheckOption("precision-check",
+                                            "Count the decisions of reduced precision networks that differ from double precision.");
+    QCommandLineOption wavefrontOption("wavefront",
+                                       "Evaluate networks layer by layer: auto (default, large networks), always or never.",
+                                       "mode");
+    QCommandLineOption recurrentOption("recurrent",
+                                       "Probability that a new connection is recurrent (default 0).",
+                                       "p");
+    QCommandLineOption networkRefreshOption("network-refresh",
+                                            "Least time in ms between redraws of the best network in game windows, 0 hides it (default 500).",
+                                            "ms");
+    QCommandLineOption spectateOption("spectate",
+                                      "Game windows draw only the k mice furthest ahead.",
+                                      "k");
+    QCommandLineOption spectateDotsOption("spectate-dots",
+                                          "With --spectate, draw the other mice as dots.");
+    QCommandLineOption spectateFpsOption("spectate-fps",
+                                         "Frames per second with --spectate (default 10).",
+                                         "n");
+    QCommandLineOption sensorsOption("sensors",
+                                     "Inputs of the networks: legacy (default), rays or egocentric.",
+                                     "encoding");
+    QCommandLineOption raysOption("rays",
+                                  "Number of rays with --sensors rays (default 9).",
+                                  "n");
+    QCommandLineOption fieldOfViewOption("field-of-view",
+                                         "Angle in degrees the rays are spread over (default 180).",
+                                         "degrees");
+    QCommandLineOption rayRangeOption("ray-range",
+                                      "Length of the rays and range of the egocentric sensors (default 300).",
+                                      "distance");
+    QCommandLineOption tapeReportOption("tape-report",
+                                        "Print the size and speed of the population's networks before and after optimization.");
+    QCommandLineOption idleTicksOption("idle-ticks",
+                                       "End the episode of a mouse without forward progress for n ticks.",
+                                       "n");
+    QCommandLineOption tickBudgetOption("tick-budget",
+                                        "End every episode after n ticks.",
+                                        "n");
+    QCommandLineOption hopelessOption("hopeless",
+                                      "End episodes of mice that can't reach the species cutoff within the tick budget.");
+    QCommandLineOption screenTicksOption("screen-ticks",
+                                         "Screen every genome with an episode of n ticks first, headless only.",
+                                         "n");
+    QCommandLineOption screenFractionOption("screen-fraction",
+                                            "Fraction of every species that gets the full episode after screening (default 0.25).",
+                                            "f");
+    QCommandLineOption screenCheckOption("screen-check",
+                                         "Evaluate screened generations fully too and print the rank correlation.");
+    QCommandLineOption episodesOption("episodes",
+                                      "Evaluate every genome on k tracks, headless only (default 1).",
+                                      "k");
+    QCommandLineOption aggregateOption("aggregate",
+                                       "Fitness of several episodes: mean (default), min or quantile.",
+                                       "kind");
+    QCommandLineOption quantileOption("quantile",
+                                      "Quantile used by --aggregate quantile (default 0.25).",
+                                      "q");
+    QCommandLineOption noCacheOption("no-fitness-cache",
+                                     "Evaluate every genome, even if an identical one was evaluated on the same tracks.");
+    QCommandLineOption steadyStateOption("steady-state",
+                                         "Replace genomes one by one as they finish instead of evolving generations.");
+    QCommandLineOption islandsOption("islands",
+                                     "Evolve n independent populations on their own threads, headless only.",
+                                     "n");
+    QCommandLineOption migrationIntervalOption("migration-interval",
+                                               "Generations between migrations of the island model (default 5).",
+                                               "k");
+    QCommandLineOption migrantsOption("migrants",
+                                      "Number of genomes every island sends to the next one (default 5).",
+                                      "n");
+    QCommandLineOption checkpointOption("checkpoint",
+                                        "Save the run to the file every --checkpoint-interval generations.",
+                                        "file");
+    QCommandLineOption checkpointIntervalOption("checkpoint-interval",
+                                                "Generations between checkpoints (default 10).",
+                                                "n");
+    QCommandLineOption resumeOption("resume",
+                                    "Continue the run saved in the checkpoint file.",
+                                    "file");
+    QCommandLineOption championOption("champion",
+                                      "Write the network of the best genome to the file after every generation.",
+                                      "file");
+    QCommandLineOption exportCheckpointOption("export-checkpoint",
+                                              "Write the champion of the checkpoint file with --champion and --export-cpp and exit.",
+                                              "file");
+    QCommandLineOption exportCppOption("export-cpp",
+                                       "Generate C++ code of the best genome into the file after every generation.",
+                                       "file");
+    parser.addOption(seedOption);
+    parser.addOption(benchmarkOption);
+    parser.addOption(headlessOption);
+    parser.addOption(threadsOption);
+    parser.addOption(worldSizeOption);
+    parser.addOption(workersOption);
+    parser.addOption(workerOption);
+    parser.addOption(workerIdOption);
+    parser.addOption(benchmarkEnvOption);
+    parser.addOption(benchmarkCodegenOption);
+    parser.addOption(idleTicksOption);
+    parser.addOption(tickBudgetOption);
+    parser.addOption(hopelessOption);
+    parser.addOption(screenTicksOption);
+    parser.addOption(screenFractionOption);
+    parser.addOption(screenCheckOption);
+    parser.addOption(tapeReportOption);
+    parser.addOption(recurrentOption);
+    parser.addOption(networkRefreshOption);
+    parser.addOption(spectateOption);
+    parser.addOption(spectateDotsOption);
+    parser.addOption(spectateFpsOption);
+    parser.addOption(sensorsOption);
+    parser.addOption(raysOption);
+    parser.addOption(fieldOfViewOption);
+    parser.addOption(rayRangeOption);
+    parser.addOption(wavefrontOption);
+    parser.addOption(precisionOption);
+    parser.addOption(precisionCheckOption);
+    parser.addOption(noCacheOption);
+    parser.addOption(steadyStateOption);
+    parser.addOption(islandsOption);
+    parser.addOption(checkpointOption);
+    parser.addOption(checkpointIntervalOption);
+    parser.addOption(championOption);
+    parser.addOption(exportCppOption);
+    parser.addOption(exportCheckpointOption);
+    parser.addOption(resumeOption);
+    parser.addOption(migrationIntervalOption);
+    parser.addOption(migrantsOption);
+    parser.addOption(episodesOption);
+    parser.addOption(aggregateOption);
+    parser.addOption(quantileOption);
+
+    parser.process(arguments);
+
+    Options options;
+    if(parser.isSet(seedOption)) {
+        options.seed = parser.value(seedOption).toUInt();
+    }
+    if(parser.isSet(benchmarkOption)) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        const auto skipEmpty = Qt::SkipEmptyParts;
+#else
+        const auto skipEmpty = QString::SkipEmptyParts;
+#endif
+        foreach (const QString &s, parser.value(benchmarkOption).split(',', skipEmpty)) {
+            options.benchmarkSeeds.push_back(s.toUInt());
+        }
+    }
+
+    if(parser.isSet(workersOption)) {
+        options.workers = std::max(0, parser.value(workersOption).toInt());
+    }
+    options.workerServer = parser.value(workerOption);
+    options.workerId = parser.value(workerIdOption).toInt();
+    if(parser.isSet(benchmarkEnvOption)) {
+        options.benchmarkWorlds = std::max(1, parser.value(benchmarkEnvOption).toInt());
+    }
+    options.benchmarkCodegen = parser.isSet(benchmarkCodegenOption);
+
+    options.steadyState = parser.isSet(steadyStateOption);
+    options.checkpoint = parser.value(checkpointOption);
+    if(parser.isSet(checkpointIntervalOption)) {
+        options.checkpointInterval = std::max(1, parser.value(checkpointIntervalOption).toInt());
+    }
+    options.resume = parser.value(resumeOption);
+    options.champion = parser.value(championOption);
+    options.exportCpp = parser.value(exportCppOption);
+    options.exportCheckpoint = parser.value(exportCheckpointOption);
+    if(parser.isSet(islandsOption)) {
+        options.islands = std::max(1, parser.value(islandsOption).toInt());
+    }
+    if(parser.isSet(migrationIntervalOption)) {
+        options.migrationInterval = std::max(1, parser.value(migrationIntervalOption).toInt());
+    }
+    if(parser.isSet(migrantsOption)) {
+        options.migrants = std::max(0, parser.value(migrantsOption).toInt());
+    }
+    // a steady-state island would never reach the migration between generations
+    if(options.islands > 1 && options.steadyState) {
+        qWarning() << "Islands evolve in generations, --steady-state is not used";
+        options.steadyState = false;
+    }
+
+    // workers and their coordinator never open windows
+    options.headless = parser.isSet(headlessOption) || options.steadyState || options.islands > 1
+                       || options.workers > 0
+                       || !options.workerServer.isEmpty() || options.benchmarkWorlds > 0
+                       || options.benchmarkCodegen;
+    if(parser.isSet(threadsOption)) {
+        options.threads = parser.value(threadsOption).toInt();
+    }
+    if(parser.isSet(worldSizeOption)) {
+        options.worldSize = std::max(1, parser.value(worldSizeOption).toInt());
+    }
+    if(parser.isSet(idleTicksOption)) {
+        options.idleTicks = std::max(0, parser.value(idleTicksOption).toInt());
+    }
+    if(parser.isSet(tickBudgetOption)) {
+        options.tickBudget = std::max(0, parser.value(tickBudgetOption).toInt());
+    }
+    options.hopeless = parser.isSet(hopelessOption);
+    if(parser.isSet(screenTicksOption)) {
+        options.screenTicks = std::max(0, parser.value(screenTicksOption).toInt());
+    }
+    if(parser.isSet(screenFractionOption)) {
+        options.screenFraction = qBound(0.0, parser.value(screenFractionOption).toDouble(), 1.0);
+    }
+    options.screenCheck = parser.isSet(screenCheckOption);
+    options.tapeReport = parser.isSet(tapeReportOption);
+    QString precision = parser.value(precisionOption);
+    if(precision == "float") {
+        options.precision = Tape::Float;
+    } else if(precision == "int8") {
+        options.precision = Tape::Int8;
+    }
+    options.precisionCheck = parser.isSet(precisionCheckOption);
+    QString wavefront = parser.value(wavefrontOption);
+    if(wavefront == "always") {
+        options.wavefront = Tape::Always;
+    } else if(wavefront == "never") {
+        options.wavefront = Tape::Never;
+    }
+    if(parser.isSet(recurrentOption)) {
+        options.recurrent = qBound(0.0, parser.value(recurrentOption).toDouble(), 1.0);
+    }
+    if(parser.isSet(networkRefreshOption)) {
+        options.networkRefresh = std::max(0, parser.value(networkRefreshOption).toInt());
+    }
+    if(parser.isSet(spectateOption)) {
+        options.spectate = std::max(0, parser.value(spectateOption).toInt());
+    }
+    options.spectateDots = parser.isSet(spectateDotsOption);
+    if(parser.isSet(spectateFpsOption)) {
+        options.spectateFps = qBound(1, parser.value(spectateFpsOption).toInt(), 60);
+    }
+    QString sensors = parser.value(sensorsOption);
+    if(sensors == "rays") {
+        options.sensors.encoding = Sensors::Rays;
+    } else if(sensors == "egocentric") {
+        options.sensors.encoding = Sensors::Egocentric;
+    }
+    if(parser.isSet(raysOption)) {
+        options.sensors.rays = std::max(1, parser.value(raysOption).toInt());
+    }
+    if(parser.isSet(fieldOfViewOption)) {
+        options.sensors.fieldOfView = qBound(0.0, parser.value(fieldOfViewOption).toDouble(), 360.0);
+    }
+    if(parser.isSet(rayRangeOption)) {
+        options.sensors.range = std::max(1.0, parser.value(rayRangeOption).toDouble());
+    }
+    options.fitnessCache = !parser.isSet(noCacheOption);
+
+    if(parser.isSet(episodesOption)) {
+        options.episodes = std::max(1, parser.value(episodesOption).toInt());
+    }
+    QString aggregate = parser.value(aggregateOption);
+    if(aggregate == "min") {
+        options.aggregation.kind = Aggregation::Min;
+    } else if(aggregate == "quantile") {
+        options.aggregation.kind = Aggregation::Quantile;
+    }
+    if(parser.isSet(quantileOption)) {
+        options.aggregation.quantile = qBound(0.0, parser.value(quantileOption).toDouble(), 1.0);
+    }
+
+    return options;
+}
+
+bool isHeadless(int argc, char *argv[])
+{
+    for(int i = 1; i < argc; i++) {
+        QString arg = QString(argv[i]).section('=', 0, 0);
+        if(arg == "--headless" || arg == "--workers" || arg == "--worker"
+                || arg == "--benchmark-env" || arg == "--benchmark-codegen" || arg == "--export-checkpoint"
+                || arg == "--steady-state" || arg == "--islands") {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,120 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+
+#include "world.h"
+#include "tape.h"
+
+// Settings of an evolutionary run, read from the command line
+struct Options
+{
+    Options();
+
+    // Track of generation n is derived from the base seed,
+    // unless a fixed set of benchmark tracks is given
+    unsigned seed;
+    std::vector<unsigned> benchmarkSeeds;
+
+    // Evaluate genomes in headless worlds on a thread pool instead of game windows
+    bool headless;
+    int threads;        // 0 - one thread per core
+    int worldSize;      // number of mice in one headless world
+
+    // Coordinator: number of worker processes evaluating the batches (0 - no workers)
+    int workers;
+
+    // Worker process: name of the coordinator's local server and id of this worker
+    QString workerServer;
+    int workerId;
+
+    // Early termination of mice (0 disables a rule): no forward progress for idleTicks,
+    // episodes longer than tickBudget, and with hopeless set, mice that can't reach
+    // the fitness of the genomes kept by the previous generation's species
+    int idleTicks;
+    int tickBudget;
+    bool hopeless;
+
+    // Two-stage evaluation in headless mode (0 disables it): every genome runs screenTicks
+    // first and only screenFraction of every species gets the full episode.
+    // screenCheck also evaluates everything fully to compare the rankings.
+    int screenTicks;
+    double screenFraction;
+    bool screenCheck;
+
+    // Headless mode: precision of the networks, precisionCheck counts the decisions
+    // that differ from double precision
+    Tape::Precision precision;
+    bool precisionCheck;
+
+    // Headless mode: when tapes are evaluated layer by layer
+    Tape::Wavefront wavefront;
+
+    // Game windows: least time in ms between redraws of the best mouse's network (0 - not shown)
+    int networkRefresh;
+
+    // Game windows: spectator mode drawing only the spectate leaders (0 - all mice),
+    // the others as dots with spectateDots, spectateFps times per second
+    int spectate;
+    bool spectateDots;
+    int spectateFps;
+
+    // Inputs of the networks, set for the whole process before any world or genome is created
+    Sensors sensors;
+
+    // Probability that a new connection is recurrent (0 - only feed-forward networks)
+    double recurrent;
+
+    // Headless mode: every generation compares the optimized tapes of the population
+    // with unoptimized ones, their sizes and evaluation time
+    bool tapeReport;
+
+    // Benchmark of the headless environment with the given number of worlds (0 - no benchmark)
+    int benchmarkWorlds;
+
+    // Benchmark of the generated network built into the binary (champion.generated.h)
+    bool benchmarkCodegen;
+
+    // Island model: independent populations on their own threads, every
+    // migrationInterval generations each sends its migrants best genomes to the next one
+    int islands;
+    int migrationInterval;
+    int migrants;
+
+    // Checkpoint file written every checkpointInterval generations and a checkpoint to resume from
+    QString checkpoint;
+    int checkpointInterval;
+    QString resume;
+
+    // File the compiled network of the best genome is written to after every generation
+    QString champion;
+
+    // C++ header the best genome is generated into after every generation
+    QString exportCpp;
+
+    // Checkpoint whose champion is written to champion and exportCpp instead of running
+    QString exportCheckpoint;
+
+    // Steady-state evolution without generations, headless in this process
+    bool steadyState;
+
+    // Headless mode: genomes found in the fitness cache are not evaluated again
+    bool fitnessCache;
+
+    // Headless mode: every genome runs one episode on each of the generation's
+    // episodes tracks, their results are combined by aggregation
+    int episodes;
+    Aggregation aggregation;
+
+    // Seed of the track of the given episode of a generation
+    unsigned trackSeed(int generation, int episode = 0) const;
+};
+
+Options parseOptions(const QStringList &arguments);
+
+// Used before the application is created, to choose between QApplication and QCoreApplication
+bool isHeadless(int argc, char *argv[]);
+
+#endif // OPTIONS_H
@@ -3,13 +3,12 @@
 
 #include <QObject>
 #include <QGraphicsItem>
-#include <vector>
-
-#include "genome.h"
+#include <QPixmap>
 
+// Drawing of a mouse. The mouse itself is simulated by World,
+// Game only moves the drawing to the mouse's position.
 class Player : public QObject, public QGraphicsItem
 {
-    Q_OBJECT
 public:
     Player();
 
@@ -19,43 +18,11 @@ public:
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                QWidget *widget) override;
 
-    // Input methods
-    void keyPressEvent(QKeyEvent * event) override;
-    void keyReleaseEvent(QKeyEvent * event) override;
-
-
-    qreal angle;    // How much SHOULD the player rotate
-
-    double traveled;
-    double rotated;
-
-    qreal speed;    // How fast can the player move
-
-    QMap<char, bool> keysDown;
-    int advanceBonus;
-    bool alive;
-
-    double calcFitness();
-
-    QRectF fieldOfVisionForward() const;
-    QRectF fieldOfVisionLeft() const;
-    QRectF fieldOfVisionRight() const;
-
-
 private:
 
-    bool inWater;   // Is the player in water
-    static const qreal turningAngle; // How much CAN the player rotate
-    static const int maxSpeed;       // Maximum movement speed
-    static const qreal consumption;  // How much energy is player losing over time
-
     QColor color;   // Color of the mouse body
     QColor color2;  // Color of the mouse ears
-
-    void move();
-
-private slots:
-    void update();
+    QPixmap sprite; // Mouse drawn with both colors, shared by mice of the same colors
 };
 
 #endif // PLAYER_H
@@ -0,0 +1,186 @@
+#include "screening.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+Screening::Screening(int screenTicks, double fraction, int episodes)
+    : screenTicks{screenTicks},
+      fraction{fraction},
+      episodes{episodes},
+      spent{0},
+      estimated{0}
+{
+
+}
+
+World::Limits Screening::limits(const World::Limits &full) const
+{
+    World::Limits limits = full;
+    if(limits.tickBudget == 0 || limits.tickBudget > screenTicks) {
+        limits.tickBudget = screenTicks;
+    }
+    limits.cutoff = 0;
+    return limits;
+}
+
+const std::vector<size_t> &Screening::promote(const std::vector<EpisodeResult> &screen,
+                                              const std::vector<int> &groups)
+{
+    this->screen = screen;
+    this->groups = groups;
+    promotedGenomes.clear();
+
+    std::map<int, std::vector<size_t>> members;
+    for(size_t i = 0; i < screen.size(); i++) {
+        members[groups[i]].push_back(i);
+    }
+
+    for(auto&& group : members) {
+        std::vector<size_t> &genomes = group.second;
+        std::stable_sort(genomes.begin(), genomes.end(), [&](size_t a, size_t b) {
+            return screen[a].fitness > screen[b].fitness;
+        });
+
+        size_t keep = std::max<size_t>(1, size_t(std::ceil(fraction * genomes.size())));
+        for(size_t k = 0; k < keep && k < genomes.size(); k++) {
+            // the others already have their full result
+            if(!isFinal(screen[genomes[k]])) {
+                promotedGenomes.push_back(genomes[k]);
+            }
+        }
+    }
+
+    std::sort(promotedGenomes.begin(), promotedGenomes.end());
+    return promotedGenomes;
+}
+
+std::vector<EpisodeResult> Screening::merge(const std::vector<EpisodeResult> &full)
+{
+    std::vector<EpisodeResult> results = screen;
+
+    // per species: fitness of both stages of the promoted genomes and the weakest of them
+    struct Group
+    {
+        double screenFitness = 0;
+        double fullFitness = 0;
+        double lowest = INFINITY;
+        int shortestTicks = 0;
+    };
+    std::map<int, Group> stats;
+    Group all;
+
+    spent = 0;
+    for(auto&& r : screen) {
+        spent += r.ticks;
+    }
+
+    for(size_t k = 0; k < promotedGenomes.size(); k++) {
+        size_t i = promotedGenomes[k];
+        results[i] = full[k];
+        spent += full[k].ticks;
+
+        for(Group *g : {&stats[groups[i]], &all}) {
+            g->screenFitness += screen[i].fitness;
+            g->fullFitness += full[k].fitness;
+            if(full[k].fitness < g->lowest) {
+                g->lowest = full[k].fitness;
+                g->shortestTicks = full[k].ticks;
+            }
+        }
+    }
+
+    estimated = 0;
+    for(size_t i = 0; i < results.size(); i++) {
+        bool screenedOut = !isFinal(screen[i])
+                && !std::binary_search(promotedGenomes.begin(), promotedGenomes.end(), i);
+        if(!screenedOut) {
+            estimated += results[i].ticks;
+            continue;
+        }
+        auto search = stats.find(groups[i]);
+        const Group &g = search != stats.end() ? search->second : all;
+
+        // assumed to last as long as the weakest promoted genome of its species
+        estimated += std::max(screen[i].ticks, g.shortestTicks);
+
+        // the full episode only adds to the fitness, but the genome was screened out,
+        // so it stays below every promoted genome of its species
+        double ratio = g.screenFitness > 0 ? g.fullFitness / g.screenFitness : 1;
+        double fitness = screen[i].fitness * std::max(1.0, ratio);
+        results[i].fitness = std::min(fitness, g.lowest);
+    }
+
+    return results;
+}
+
+bool Screening::isFinal(const EpisodeResult &screen) const
+{
+    return episodes == 1 && screen.termination != World::Budget;
+}
+
+bool Screening::isExact(size_t i) const
+{
+    return isFinal(screen[i]) || std::binary_search(promotedGenomes.begin(), promotedGenomes.end(), i);
+}
+
+const std::vector<size_t> &Screening::promoted() const
+{
+    return promotedGenomes;
+}
+
+long long Screening::ticksSpent() const
+{
+    return spent;
+}
+
+long long Screening::ticksEstimated() const
+{
+    return estimated;
+}
+
+static std::vector<double> ranks(const std::vector<double> &values)
+{
+    std::vector<size_t> order(values.size());
+    for(size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+
+    std::vector<double> rank(values.size());
+    for(size_t first = 0; first < order.size(); ) {
+        size_t last = first;
+        while(last + 1 < order.size() && values[order[last + 1]] == values[order[first]]) {
+            last++;
+        }
+        for(size_t k = first; k <= last; k++) {
+            rank[order[k]] = (first + last) / 2.0;
+        }
+        first = last + 1;
+    }
+    return rank;
+}
+
+double Screening::rankCorrelation(const std::vector<double> &a, const std::vector<double> &b)
+{
+    std::vector<double> ra = ranks(a);
+    std::vector<double> rb = ranks(b);
+    size_t n = ra.size();
+    if(n < 2) {
+        return 1;
+    }
+
+    double meanA = 0, meanB = 0;
+    for(size_t i = 0; i < n; i++) {
+        meanA += ra[i] / n;
+        meanB += rb[i] / n;
+    }
+
+    double cov = 0, varA = 0, varB = 0;
+    for(size_t i = 0; i < n; i++) {
+        cov += (ra[i] - meanA) * (rb[i] - meanB);
+        varA += (ra[i] - meanA) * (ra[i] - meanA);
+        varB += (rb[i] - meanB) * (rb[i] - meanB);
+    }
+    return varA > 0 && varB > 0 ? cov / std::sqrt(varA * varB) : 1;
+}
@@ -0,0 +1,60 @@
+#ifndef SCREENING_H
+#define SCREENING_H
+
+#include <vector>
+
+#include "world.h"
+
+// Two-stage evaluation. Every genome first runs a short episode on the generation's
+// track, only the best fraction of every species continues to the full episode.
+//
+// Mice are independent and the simulation is deterministic, so a mouse that ended
+// before the short budget has its full result already. Genomes that were cut by
+// the budget and screened out get fitness extrapolated from the promoted genomes
+// of their species, never above the weakest of them.
+class Screening
+{
+public:
+    // With more than one episode the short one covers only the first track,
+    // so no genome has its full result after screening
+    Screening(int screenTicks, double fraction, int episodes = 1);
+
+    // Limits of the short episode, the hopeless rule is left to the full episode
+    World::Limits limits(const World::Limits &full) const;
+
+    // Chooses genomes for the full episode, groups[i] is the species of genome i
+    const std::vector<size_t> &promote(const std::vector<EpisodeResult> &screen,
+                                       const std::vector<int> &groups);
+
+    // Results of all genomes, full[k] is the full result of promoted()[k]
+    std::vector<EpisodeResult> merge(const std::vector<EpisodeResult> &full);
+
+    const std::vector<size_t> &promoted() const;
+
+    // true if the merged result of genome i is what the full episode gives
+    bool isExact(size_t i) const;
+
+    // Simulated ticks of both stages and an estimate of the ticks of evaluating everything fully
+    long long ticksSpent() const;
+    long long ticksEstimated() const;
+
+    // Spearman's rank correlation, ties get their average rank
+    static double rankCorrelation(const std::vector<double> &a, const std::vector<double> &b);
+
+private:
+    int screenTicks;
+    double fraction;
+    int episodes;
+
+    std::vector<EpisodeResult> screen;
+    std::vector<int> groups;
+    std::vector<size_t> promotedGenomes;
+
+    long long spent;
+    long long estimated;
+
+    // true if the short episode of a genome is already its full result
+    bool isFinal(const EpisodeResult &screen) const;
+};
+
+#endif // SCREENING_H
@@ -1,10 +1,12 @@
 #include "species.h"
+#include <algorithm>
+#include <numeric>
 #include <random>
 #include <QDebug>
 
 Species::Species(Genome *p)
     : bestFitness{0}, averageFitness{0}, stagnantCoeff{0}, allowedReproduction{true},
-      excessCoeff{1}, weightDiffCoeff{0.4}, compatibilityThreshold{3}
+      excessCoeff{1}, weightDiffCoeff{0.4}, activationDiffCoeff{1}, compatibilityThreshold{3}
 {
     genomes.push_back(p);
     bestFitness = p->fitness;       // Best fitness, because it is the only Genome
@@ -56,6 +58,17 @@ bool Species::isSameSpecies(const Genome &genome)
     else
         averageWeightDiff = totalDiff / matchingWeightDiff;
 
+    // Nodes of both genomes with different activation functions count like excess genes
+    unsigned differentActivations = 0;
+    for (auto&& node : genome.nodes) {
+        for (auto&& representNode : representGenome->nodes) {
+            if (node->id == representNode->id) {
+                differentActivations += node->activation != representNode->activation;
+                break;
+            }
+        }
+    }
+
     // Calculate N - number of genes in the larger genome
     double largeGenomeNormalizer = genome.connections.size();
     if (largeGenomeNormalizer < 20) {    // Small genomes, both have less than 20 genes
@@ -64,7 +77,8 @@ bool Species::isSameSpecies(const Genome &genome)
 
     // Now calculate the compatibility function
     double tmp1 = excessCoeff * excessAndDisjoint / largeGenomeNormalizer;
-    double compatibilityDistance = tmp1 + (weightDiffCoeff * averageWeightDiff);
+    double tmp2 = activationDiffCoeff * differentActivations / largeGenomeNormalizer;
+    double compatibilityDistance = tmp1 + (weightDiffCoeff * averageWeightDiff) + tmp2;
 
     return (compatibilityThreshold > compatibilityDistance);
 }
@@ -93,6 +107,11 @@ void Species::addToSpecies(Genome *genome)
     genomes.push_back(genome);
 }
 
+void Species::removeFromSpecies(Genome *genome)
+{
+    genomes.erase(std::remove(genomes.begin(), genomes.end(), genome), genomes.end());
+}
+
 Genome* Species::createOffspring()
 {
     std::random_device rd;
@@ -1,7 +1,7 @@
 #ifndef SPECIES_H
 #define SPECIES_H
 
-#include "player.h"
+#include "genome.h"
 
 class Species
 {
@@ -16,6 +16,8 @@ public:
 
     void addToSpecies(Genome* genome);
 
+    void removeFromSpecies(Genome* genome);
+
     Genome* selectParent();              // Select a genome from this species
 
     Genome* createOffspring();
@@ -39,6 +41,7 @@ private:
     // Parameters for compatibility function
     double excessCoeff;
     double weightDiffCoeff;
+    double activationDiffCoeff;
     double compatibilityThreshold;
 };
 
@@ -0,0 +1,113 @@
+#include "sprites.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QRandomGenerator>
+
+// Mice are rendered at twice the scene resolution so they stay sharp when rotated or zoomed
+static const qreal mouseScale = 2;
+
+QHash<QString, QPixmap> Sprites::images;
+QHash<QPair<QRgb, QRgb>, QPixmap> Sprites::mice;
+
+const QPixmap &Sprites::cheese()
+{
+    return load(":/img/cheese.png");
+}
+
+const QPixmap &Sprites::mouseTrap()
+{
+    return load(":/img/mousetrap.png");
+}
+
+const QPixmap &Sprites::cat()
+{
+    return load(":/img/cat.png");
+}
+
+const QPixmap &Sprites::water()
+{
+    return load(":/img/water1.png");
+}
+
+const QPixmap &Sprites::load(const QString &name)
+{
+    auto it = images.find(name);
+    if(it == images.end()) {
+        it = images.insert(name, QPixmap(name));
+    }
+    return *it;
+}
+
+QColor Sprites::randomColor()
+{
+    static const QRgb palette[paletteSize] = {
+        0x8b5a2b, 0x9e9e9e, 0xf5f5dc, 0x4a4a4a, 0xd2691e, 0xffc0cb, 0x6495ed, 0xdaa520
+    };
+    return QColor(palette[QRandomGenerator::global()->bounded(paletteSize)]);
+}
+
+QRectF Sprites::mouseRect()
+{
+    qreal adjust = 0.5;
+    return QRectF(-18 - adjust, -22 - adjust,
+                  36 + adjust, 60 + adjust);
+}
+
+QPixmap Sprites::mouse(const QColor &body, const QColor &ears)
+{
+    QPair<QRgb, QRgb> key(body.rgba(), ears.rgba());
+    auto it = mice.find(key);
+    if(it != mice.end()) {
+        return *it;
+    }
+
+    QRectF rect = mouseRect();
+    QPixmap sprite((rect.size() * mouseScale).toSize());
+    sprite.setDevicePixelRatio(mouseScale);
+    sprite.fill(Qt::transparent);
+
+    QPainter painter(&sprite);
+    painter.translate(-rect.topLeft());
+    drawMouse(&painter, body, ears);
+    painter.end();
+
+    mice.insert(key, sprite);
+    return sprite;
+}
+
+// Taken from the CollidingMice example and slightly modified
+void Sprites::drawMouse(QPainter *painter, const QColor &body, const QColor &ears)
+{
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    // Body
+    painter->setBrush(body);
+    painter->drawEllipse(-10, -20, 20, 40);
+
+    // Eyes
+    painter->setBrush(Qt::white);
+    painter->drawEllipse(-10, -17, 8, 8);
+    painter->drawEllipse(2, -17, 8, 8);
+
+    // Nose
+    painter->setBrush(Qt::black);
+    painter->drawEllipse(QRectF(-2, -22, 4, 4));
+
+    // Pupils
+    painter->drawEllipse(QRectF(-8.0, -17, 4, 4));
+    painter->drawEllipse(QRectF(4.0, -17, 4, 4));
+
+    // Ears
+    painter->setBrush(ears);
+    painter->drawEllipse(-17, -12, 16, 16);
+    painter->drawEllipse(1, -12, 16, 16);
+
+    // Tail
+    QPainterPath path(QPointF(0, 20));
+    path.cubicTo(-5, 22, -5, 22, 0, 25);
+    path.cubicTo(5, 27, 5, 32, 0, 30);
+    path.cubicTo(-5, 32, -5, 42, 0, 35);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(path);
+}
@@ -0,0 +1,40 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <QColor>
+#include <QHash>
+#include <QPixmap>
+#include <QRectF>
+
+// Images of the scene items, loaded from the resources once and shared by all items.
+// Mice are rendered into a pixmap once per pair of colors instead of being drawn
+// shape by shape in every frame. Their colors come from a small palette, so there are
+// at most paletteSize * paletteSize mouse sprites. Only used from the GUI thread.
+class Sprites
+{
+public:
+    static const QPixmap &cheese();
+    static const QPixmap &mouseTrap();
+    static const QPixmap &cat();
+    static const QPixmap &water();
+
+    static const int paletteSize = 8;
+
+    // Random color of the palette
+    static QColor randomColor();
+
+    // Mouse with the given colors of the body and the ears, covering mouseRect()
+    static QPixmap mouse(const QColor &body, const QColor &ears);
+    static QRectF mouseRect();
+
+private:
+    static const QPixmap &load(const QString &name);
+
+    // Vector drawing of a mouse in item coordinates
+    static void drawMouse(QPainter *painter, const QColor &body, const QColor &ears);
+
+    static QHash<QString, QPixmap> images;
+    static QHash<QPair<QRgb, QRgb>, QPixmap> mice;
+};
+
+#endif // SPRITES_H
@@ -0,0 +1,301 @@
+#include "steadystate.h"
+#include "evaluator.h"
+#include "tape.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <QDebug>
+#include <QElapsedTimer>
+
+SteadyState::SteadyState(ThreadPool &pool, const Options &options,
+                         std::vector<Genome*> &population, std::vector<Species*> &species,
+                         std::function<void(Genome*)> adopt, std::function<void(long long)> generationDone)
+    : pool(pool),
+      options{options},
+      population(population),
+      species(species),
+      adopt{adopt},
+      generationDone{generationDone},
+      generationSize{population.size()},
+      gen{std::random_device{}()}
+{
+    for(int e = 0; e < options.episodes; e++) {
+        tracks.push_back(std::make_shared<const Track>(options.trackSeed(0, e)));
+    }
+}
+
+void SteadyState::run(long long numEvaluations)
+{
+    // enough queued evaluations to keep every thread busy while the next offspring is bred
+    const long long target = 2 * pool.size();
+
+    QElapsedTimer time;
+    time.start();
+
+    long long submitted = 0;
+    long long finished = 0;
+    long long inFlight = 0;
+
+    for(auto&& genome : population) {
+        genome->fitness = 0;
+        genome->termination = World::Running;
+        submit(genome);
+        submitted++;
+        inFlight++;
+    }
+
+    while(inFlight > 0) {
+        Completion c;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            completed.wait(lock, [this]{ return !completions.empty(); });
+            c = completions.front();
+            completions.pop_front();
+        }
+        inFlight--;
+        finished++;
+
+        c.genome->fitness = c.result.fitness;
+        c.genome->termination = c.result.termination;
+        c.genome->trackSeed = tracks[0]->seed();
+
+        Species *s = speciesOf(c.genome);
+        if(!s) {
+            s = speciate(c.genome);
+        }
+
+        // species check their stagnation at the old generation boundary
+        if(finished % generationSize == 0) {
+            for(auto&& sp : species) {
+                Genome *previous = sp->representGenome;
+                sp->sortGenomesByFitness();
+                if(sp->representGenome != previous) {
+                    release(previous);
+                }
+            }
+            report(finished, time.elapsed() / 1000.0);
+            generationDone(finished / (long long)generationSize);
+        }
+
+        while(inFlight < target && submitted < numEvaluations) {
+            Genome *replaced = chooseReplaced(s);
+            if(!replaced) {
+                break;
+            }
+
+            Genome *child = breed();
+            if(s && s->genomes.size() == 1 && s->genomes[0] == replaced) {
+                // the species dies with its last genome
+                s = nullptr;
+            }
+            remove(replaced);
+
+            child->fitness = 0;
+            child->termination = World::Running;
+            adopt(child);
+            child->mutate();
+            speciate(child);
+            population.push_back(child);
+
+            submit(child);
+            submitted++;
+            inFlight++;
+        }
+    }
+}
+
+void SteadyState::submit(Genome *genome)
+{
+    // compiled on this thread, genomes are only read and changed here
+    std::shared_ptr<const Tape> tape = genome->tape();
+    World::Limits limits;
+    limits.idleTicks = options.idleTicks;
+    limits.tickBudget = options.tickBudget;
+
+    pool.submit([this, genome, tape, limits]() {
+        EpisodeResult result = Evaluator::evaluate(*tape, tracks, limits, options.aggregation,
+                                                   options.precision);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completions.push_back(Completion{genome, result});
+        completed.notify_one();
+    });
+}
+
+Species *SteadyState::speciesOf(Genome *genome) const
+{
+    for(auto&& s : species) {
+        if(std::find(s->genomes.begin(), s->genomes.end(), genome) != s->genomes.end()) {
+            return s;
+        }
+    }
+    return nullptr;
+}
+
+Species *SteadyState::speciate(Genome *genome)
+{
+    for(auto&& s : species) {
+        if(s->isSameSpecies(*genome)) {
+            s->addToSpecies(genome);
+            return s;
+        }
+    }
+    species.push_back(new Species(genome));
+    return species.back();
+}
+
+bool SteadyState::isEvaluated(const Genome *genome)
+{
+    return genome->termination != World::Running;
+}
+
+double SteadyState::averageFitness(const Species *s)
+{
+    double sum = 0;
+    int count = 0;
+    for(auto&& genome : s->genomes) {
+        if(isEvaluated(genome)) {
+            sum += genome->fitness;
+            count++;
+        }
+    }
+    return count > 0 ? sum / count : 0;
+}
+
+Genome *SteadyState::chooseReplaced(Species *s) const
+{
+    Genome *best = nullptr;
+    for(auto&& genome : population) {
+        if(isEvaluated(genome) && (!best || genome->fitness > best->fitness)) {
+            best = genome;
+        }
+    }
+
+    // stagnant species die out one genome at a time, the best genome is never replaced
+    Genome *stale = nullptr;
+    for(auto&& sp : species) {
+        if(sp->allowedReproduction) {
+            continue;
+        }
+        for(auto&& genome : sp->genomes) {
+            if(isEvaluated(genome) && genome != best && (!stale || genome->fitness < stale->fitness)) {
+                stale = genome;
+            }
+        }
+    }
+    if(stale) {
+        return stale;
+    }
+
+    if(s) {
+        Genome *worst = nullptr;
+        int count = 0;
+        for(auto&& genome : s->genomes) {
+            if(!isEvaluated(genome)) {
+                continue;
+            }
+            count++;
+            if(!worst || genome->fitness < worst->fitness) {
+                worst = genome;
+            }
+        }
+        if(count > 1) {
+            return worst;
+        }
+    }
+
+    // the lowest fitness shared by the species size
+    Genome *worst = nullptr;
+    double worstAdjusted = 0;
+    for(auto&& sp : species) {
+        for(auto&& genome : sp->genomes) {
+            if(!isEvaluated(genome)) {
+                continue;
+            }
+            double adjusted = genome->fitness / sp->genomes.size();
+            if(!worst || adjusted < worstAdjusted) {
+                worst = genome;
+                worstAdjusted = adjusted;
+            }
+        }
+    }
+    return worst != best ? worst : nullptr;
+}
+
+Genome *SteadyState::breed()
+{
+    std::vector<Species*> parents;
+    std::vector<double> weights;
+    for(auto&& s : species) {
+        if(s->allowedReproduction && averageFitness(s) >= 0) {
+            parents.push_back(s);
+            weights.push_back(averageFitness(s));
+        }
+    }
+    if(parents.empty()) {
+        parents = species;
+        weights.assign(species.size(), 1);
+    }
+
+    Species *parent = parents[0];
+    if(std::accumulate(weights.begin(), weights.end(), 0.0) > 0) {
+        std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+        parent = parents[dist(gen)];
+    } else {
+        parent = parents[std::uniform_int_distribution<size_t>(0, parents.size() - 1)(gen)];
+    }
+    return parent->createOffspring();
+}
+
+void SteadyState::remove(Genome *genome)
+{
+    population.erase(std::remove(population.begin(), population.end(), genome), population.end());
+
+    Species *s = speciesOf(genome);
+    if(s) {
+        s->removeFromSpecies(genome);
+        if(s->genomes.empty()) {
+            species.erase(std::remove(species.begin(), species.end(), s), species.end());
+            if(s->representGenome != genome) {
+                release(s->representGenome);
+            }
+            delete s;
+        }
+    }
+
+    // representatives are still compared with new genomes, release frees them later
+    for(auto&& sp : species) {
+        if(sp->representGenome == genome) {
+            return;
+        }
+    }
+    delete genome;
+}
+
+void SteadyState::release(Genome *representative)
+{
+    if(std::find(population.begin(), population.end(), representative) == population.end()) {
+        delete representative;
+    }
+}
+
+void SteadyState::report(long long evaluations, double seconds) const
+{
+    double best = 0;
+    double sum = 0;
+    int count = 0;
+    for(auto&& genome : population) {
+        if(isEvaluated(genome)) {
+            best = std::max(best, genome->fitness);
+            sum += genome->fitness;
+            count++;
+        }
+    }
+
+    qDebug() << "Evaluations:" << evaluations
+             << "Best:" << best
+             << "Average:" << (count > 0 ? sum / count : 0)
+             << "Species:" << species.size()
+             << "Evaluations/s:" << (seconds > 0 ? evaluations / seconds : 0);
+}
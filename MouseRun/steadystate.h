@@ -0,0 +1,87 @@
+#ifndef STEADYSTATE_H
+#define STEADYSTATE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "genome.h"
+#include "species.h"
+#include "options.h"
+#include "threadpool.h"
+#include "track.h"
+#include "world.h"
+
+// Steady-state evolution (rtNEAT). Every genome runs in its own world on the thread pool
+// and as soon as one finishes, the worst genome of its species is replaced by an offspring
+// that starts running right away, so the pool never waits for a generation to end.
+// Species and their average fitness are updated with every replacement.
+class SteadyState
+{
+public:
+    // adopt is called for every new genome before it mutates (ids of new genes come from the controller),
+    // generationDone after every population size of evaluations with the number of them so far
+    SteadyState(ThreadPool &pool, const Options &options,
+                std::vector<Genome*> &population, std::vector<Species*> &species,
+                std::function<void(Genome*)> adopt, std::function<void(long long)> generationDone);
+
+    // Runs until numEvaluations genomes were evaluated
+    void run(long long numEvaluations);
+
+private:
+    struct Completion
+    {
+        Genome *genome;
+        EpisodeResult result;
+    };
+
+    ThreadPool &pool;
+    Options options;
+    std::vector<Genome*> &population;
+    std::vector<Species*> &species;
+    std::function<void(Genome*)> adopt;
+    std::function<void(long long)> generationDone;
+
+    // evaluations counted as one generation
+    size_t generationSize;
+
+    // own generator, a static one would be shared by controllers on other threads
+    std::mt19937 gen;
+
+    // every genome runs on the same tracks, so all fitness values are comparable
+    std::vector<std::shared_ptr<const Track>> tracks;
+
+    std::mutex mutex;
+    std::condition_variable completed;
+    std::deque<Completion> completions;
+
+    void submit(Genome *genome);
+
+    Species *speciesOf(Genome *genome) const;
+    Species *speciate(Genome *genome);
+
+    static bool isEvaluated(const Genome *genome);
+
+    // Average fitness of the evaluated genomes of a species, shared by their number
+    static double averageFitness(const Species *s);
+
+    // The worst evaluated genome of a stagnant species, else the worst of the species,
+    // or of the whole population if it is the only evaluated one in its species
+    Genome *chooseReplaced(Species *s) const;
+
+    // Offspring of a species chosen by roulette on the average fitness
+    Genome *breed();
+
+    void remove(Genome *genome);
+
+    // Frees a former representative of a species if it already left the population
+    void release(Genome *representative);
+
+    void report(long long evaluations, double seconds) const;
+};
+
+#endif // STEADYSTATE_H
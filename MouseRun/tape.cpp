@@ -0,0 +1,878 @@
+#include "tape.h"
+#include "genome.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <QDataStream>
+
+const quint32 Tape::magic;
+const quint32 Tape::version;
+const size_t Tape::wavefrontEdges;
+
+Tape::Wavefront Tape::wavefront = Tape::Auto;
+
+// One kind of activation over a run of values, the kind is known at compile time
+// so the loop has no branch on it
+template<int activation, typename T>
+static inline void activateRange(T *values, int count)
+{
+    for(int i = 0; i < count; i++) {
+        values[i] = NodeGene::activationFunction(activation, values[i]);
+    }
+}
+
+Tape::Tape(const Genome &genome, bool optimize)
+    : inputs{genome.numInputs},
+      outputs{genome.numOutputs},
+      numValues{0},
+      numState{0},
+      constantValues(genome.nodes.size(), 0),
+      scale{1}
+{
+    for(auto&& conn : genome.connections) {
+        weights.push_back(conn->weight);
+    }
+
+    // nodes are indexed the same way as genome.nodes until they get their value slots
+    size_t numNodes = genome.nodes.size();
+    std::map<const NodeGene*, int> indexOf;
+    for(size_t i = 0; i < numNodes; i++) {
+        indexOf[genome.nodes[i]] = int(i);
+    }
+    std::map<const ConnectionGene*, int> connectionOf;
+    for(size_t c = 0; c < genome.connections.size(); c++) {
+        connectionOf[genome.connections[c]] = int(c);
+    }
+
+    // the same order as in Genome::feedForward, so the sums are added in the same order
+    std::vector<NodeGene*> sortedNodes = genome.nodes;
+    std::sort(sortedNodes.begin(), sortedNodes.end(),
+              [](NodeGene *a, NodeGene *b){return a->layer < b->layer;});
+
+    // incoming terms of every node, disabled connections are dropped. Recurrent terms
+    // come first, feedForward adds them before it activates any node.
+    std::vector<std::vector<Term>> incoming(numNodes);
+    std::vector<char> recurrentSource(numNodes, 0);
+    for(bool recurrent : {true, false}) {
+        for(auto&& node : sortedNodes) {
+            for(auto&& conn : node->outputConnections) {
+                if(!conn->enabled || conn->isRecurrent() != recurrent) {
+                    continue;
+                }
+                std::vector<Term> &terms = incoming[indexOf[conn->outNode]];
+                int from = indexOf[node];
+                recurrentSource[from] |= recurrent;
+
+                // parallel connections are merged into the first one
+                auto parallel = std::find_if(terms.begin(), terms.end(),
+                                             [from](const Term &t){return t.from == from;});
+                if(optimize && parallel != terms.end()) {
+                    parallel->connections.push_back(connectionOf[conn]);
+                } else {
+                    terms.push_back({from, recurrent, {connectionOf[conn]}});
+                }
+            }
+        }
+    }
+
+    std::vector<int> order;
+    for(auto&& node : sortedNodes) {
+        if(node->layer > 0) {
+            order.push_back(indexOf[node]);
+        }
+    }
+
+    // nodes that don't depend on an input are constants, starting with the bias. Recurrent
+    // terms change after the first evaluation and their sources have to keep their state.
+    std::vector<char> constant(numNodes, 0);
+    if(optimize) {
+        constant[genome.biasNodeId] = 1;
+        for(int node : order) {
+            constant[node] = !recurrentSource[node]
+                    && std::all_of(incoming[node].begin(), incoming[node].end(),
+                                   [&constant](const Term &t){return !t.recurrent && constant[t.from];});
+        }
+    }
+
+    // nodes needed by the outputs, walked back from them until recurrent cycles are closed
+    std::vector<char> live(numNodes, !optimize);
+    std::vector<int> walk;
+    for(int i = inputs; i < inputs + outputs; i++) {
+        live[i] = 1;
+        walk.push_back(i);
+    }
+    while(optimize && !walk.empty()) {
+        int node = walk.back();
+        walk.pop_back();
+        for(auto&& term : incoming[node]) {
+            if(!live[term.from]) {
+                live[term.from] = 1;
+                walk.push_back(term.from);
+            }
+        }
+    }
+    live[genome.biasNodeId] = 1;
+
+    // value slots: the inputs first, then every layer with its nodes grouped by activation,
+    // so one instruction activates a whole group
+    std::vector<int> slot(numNodes, -1);
+    std::vector<int> state(numNodes, -1);
+    for(int i = 0; i < inputs; i++) {
+        slot[i] = int(numValues++);
+        if(live[i]) {
+            tape.push_back({Input, slot[i], i, 0});
+        }
+    }
+    if(!optimize) {
+        slot[genome.biasNodeId] = int(numValues++);
+        tape.push_back({Constant, slot[genome.biasNodeId], 0, 1});
+    }
+    constantValues[genome.biasNodeId] = 1;
+
+    for(size_t first = 0; first < order.size();) {
+        int layer = genome.nodes[order[first]]->layer;
+        std::vector<int> group;
+        size_t next = first;
+        for(; next < order.size() && genome.nodes[order[next]]->layer == layer; next++) {
+            int node = order[next];
+            if(!live[node]) {
+                continue;
+            }
+            if(constant[node]) {
+                constants.push_back({node, genome.nodes[node]->activation, incoming[node]});
+                continue;
+            }
+            group.push_back(node);
+        }
+        first = next;
+
+        // stable, the nodes of one activation keep the order of feedForward
+        std::stable_sort(group.begin(), group.end(), [&genome](int a, int b) {
+            return genome.nodes[a]->activation < genome.nodes[b]->activation;
+        });
+
+        for(int node : group) {
+            slot[node] = int(numValues++);
+            for(auto&& term : incoming[node]) {
+                patches.push_back({int(tape.size()), term});
+                if(term.recurrent) {
+                    // sources get their state slots in the order they are first read
+                    if(state[term.from] < 0) {
+                        state[term.from] = int(numState++);
+                    }
+                    tape.push_back({Recall, 0, state[term.from], 0});
+                } else if(constant[term.from]) {
+                    tape.push_back({Add, 0, 0, 0});
+                } else {
+                    tape.push_back({Fma, 0, slot[term.from], 0});
+                }
+            }
+            tape.push_back({Store, slot[node], 0, 0});
+        }
+
+        for(size_t i = 0; i < group.size();) {
+            int activation = genome.nodes[group[i]]->activation;
+            size_t end = i;
+            while(end < group.size() && genome.nodes[group[end]]->activation == activation) {
+                end++;
+            }
+            tape.push_back({Opcode(Sigmoid + activation), slot[group[i]], int(end - i), 0});
+            i = end;
+        }
+    }
+
+    // state for the next evaluation, after every node of this one is activated
+    for(size_t node = 0; node < numNodes; node++) {
+        if(state[node] >= 0) {
+            tape.push_back({Keep, state[node], slot[node], 0});
+        }
+    }
+
+    // outputs that were folded get their constant value
+    for(int i = inputs; i < inputs + outputs; i++) {
+        if(slot[i] < 0) {
+            slot[i] = int(numValues++);
+            patches.push_back({int(tape.size()), {i, false, {}}});
+            tape.push_back({Constant, slot[i], 0, 0});
+        }
+    }
+
+    for(int i = 0; i < outputs; i++) {
+        tape.push_back({Output, i, slot[inputs + i], 0});
+    }
+    tape.push_back({Halt, 0, 0, 0});
+
+    foldConstants();
+    patch();
+}
+
+int Tape::numInputs() const
+{
+    return inputs;
+}
+
+int Tape::numOutputs() const
+{
+    return outputs;
+}
+
+size_t Tape::size() const
+{
+    return numValues;
+}
+
+size_t Tape::stateSize() const
+{
+    return numState;
+}
+
+const std::vector<Tape::Instruction> &Tape::instructions() const
+{
+    return tape;
+}
+
+size_t Tape::numActivations() const
+{
+    size_t count = 0;
+    for(auto&& instruction : tape) {
+        if(instruction.op >= Sigmoid && instruction.op <= Identity) {
+            count += instruction.source;
+        }
+    }
+    return count;
+}
+
+size_t Tape::numEdges() const
+{
+    return std::count_if(tape.begin(), tape.end(),
+                         [](const Instruction &i){return i.op == Fma || i.op == Add || i.op == Recall;});
+}
+
+// bodies of the activation instructions, shared by both interpreters
+#define ACTIVATE(kind) activateRange<NodeGene::kind>(values + ip->target, ip->source)
+
+void Tape::evaluate(const double *in, double *out, double *values, double *state) const
+{
+    if(!layers.empty()) {
+        runLayers(in, out, values, state);
+        return;
+    }
+
+    const Instruction *ip = tape.data();
+    double sum = 0;
+
+#if defined(__GNUC__)
+    // computed goto, every instruction jumps straight to the next one
+    static const void *labels[] = {&&input, &&constant, &&fma, &&add, &&recall, &&store,
+                                   &&sigmoid, &&tanh, &&relu, &&step, &&gaussian, &&identity,
+                                   &&keep, &&output, &&halt};
+#define DISPATCH() goto *labels[ip->op]
+#define NEXT() do { ip++; DISPATCH(); } while(0)
+
+    DISPATCH();
+input:
+    values[ip->target] = in[ip->source];
+    NEXT();
+constant:
+    values[ip->target] = ip->weight;
+    NEXT();
+fma:
+    sum += ip->weight * values[ip->source];
+    NEXT();
+add:
+    sum += ip->weight;
+    NEXT();
+recall:
+    sum += ip->weight * state[ip->source];
+    NEXT();
+store:
+    values[ip->target] = sum;
+    sum = 0;
+    NEXT();
+sigmoid:
+    ACTIVATE(Sigmoid);
+    NEXT();
+tanh:
+    ACTIVATE(Tanh);
+    NEXT();
+relu:
+    ACTIVATE(Relu);
+    NEXT();
+step:
+    ACTIVATE(Step);
+    NEXT();
+gaussian:
+    ACTIVATE(Gaussian);
+    NEXT();
+identity:
+    NEXT();
+keep:
+    state[ip->target] = values[ip->source];
+    NEXT();
+output:
+    out[ip->target] = values[ip->source];
+    NEXT();
+halt:
+    return;
+
+#undef NEXT
+#undef DISPATCH
+#else
+    for(;; ip++) {
+        switch(ip->op) {
+        case Input:
+            values[ip->target] = in[ip->source];
+            break;
+        case Constant:
+            values[ip->target] = ip->weight;
+            break;
+        case Fma:
+            sum += ip->weight * values[ip->source];
+            break;
+        case Add:
+            sum += ip->weight;
+            break;
+        case Recall:
+            sum += ip->weight * state[ip->source];
+            break;
+        case Store:
+            values[ip->target] = sum;
+            sum = 0;
+            break;
+        case Sigmoid:
+            ACTIVATE(Sigmoid);
+            break;
+        case Tanh:
+            ACTIVATE(Tanh);
+            break;
+        case Relu:
+            ACTIVATE(Relu);
+            break;
+        case Step:
+            ACTIVATE(Step);
+            break;
+        case Gaussian:
+            ACTIVATE(Gaussian);
+            break;
+        case Identity:
+            break;
+        case Keep:
+            state[ip->target] = values[ip->source];
+            break;
+        case Output:
+            out[ip->target] = values[ip->source];
+            break;
+        case Halt:
+            return;
+        }
+    }
+#endif
+}
+
+const char *Tape::precisionName(Precision precision)
+{
+    static const char *names[] = {"double", "float", "int8"};
+    return names[precision];
+}
+
+void Tape::evaluate(const double *in, double *out, float *values, float *state,
+                    Precision precision) const
+{
+    if(precision == Int8) {
+        run<true>(in, out, values, state);
+    } else {
+        run<false>(in, out, values, state);
+    }
+}
+
+template<bool quantized>
+void Tape::run(const double *in, double *out, float *values, float *state) const
+{
+    const Instruction *ip = tape.data();
+    const float *floats = floatWeights.data();
+    const qint8 *bytes = quantizedWeights.data();
+    // sums of the quantized tape are in units of scale until they are stored
+    const float sumScale = quantized ? scale : 1;
+    float sum = 0;
+
+#define WEIGHT() (quantized ? float(bytes[ip - tape.data()]) : floats[ip - tape.data()])
+#if defined(__GNUC__)
+    static const void *labels[] = {&&input, &&constant, &&fma, &&add, &&recall, &&store,
+                                   &&sigmoid, &&tanh, &&relu, &&step, &&gaussian, &&identity,
+                                   &&keep, &&output, &&halt};
+#define DISPATCH() goto *labels[ip->op]
+#define NEXT() do { ip++; DISPATCH(); } while(0)
+
+    DISPATCH();
+input:
+    values[ip->target] = float(in[ip->source]);
+    NEXT();
+constant:
+    values[ip->target] = floats[ip - tape.data()];
+    NEXT();
+fma:
+    sum += WEIGHT() * values[ip->source];
+    NEXT();
+add:
+    sum += WEIGHT();
+    NEXT();
+recall:
+    sum += WEIGHT() * state[ip->source];
+    NEXT();
+store:
+    values[ip->target] = sum * sumScale;
+    sum = 0;
+    NEXT();
+sigmoid:
+    ACTIVATE(Sigmoid);
+    NEXT();
+tanh:
+    ACTIVATE(Tanh);
+    NEXT();
+relu:
+    ACTIVATE(Relu);
+    NEXT();
+step:
+    ACTIVATE(Step);
+    NEXT();
+gaussian:
+    ACTIVATE(Gaussian);
+    NEXT();
+identity:
+    NEXT();
+keep:
+    state[ip->target] = values[ip->source];
+    NEXT();
+output:
+    out[ip->target] = values[ip->source];
+    NEXT();
+halt:
+    return;
+
+#undef NEXT
+#undef DISPATCH
+#else
+    for(;; ip++) {
+        switch(ip->op) {
+        case Input:
+            values[ip->target] = float(in[ip->source]);
+            break;
+        case Constant:
+            values[ip->target] = floats[ip - tape.data()];
+            break;
+        case Fma:
+            sum += WEIGHT() * values[ip->source];
+            break;
+        case Add:
+            sum += WEIGHT();
+            break;
+        case Recall:
+            sum += WEIGHT() * state[ip->source];
+            break;
+        case Store:
+            values[ip->target] = sum * sumScale;
+            sum = 0;
+            break;
+        case Sigmoid:
+            ACTIVATE(Sigmoid);
+            break;
+        case Tanh:
+            ACTIVATE(Tanh);
+            break;
+        case Relu:
+            ACTIVATE(Relu);
+            break;
+        case Step:
+            ACTIVATE(Step);
+            break;
+        case Gaussian:
+            ACTIVATE(Gaussian);
+            break;
+        case Identity:
+            break;
+        case Keep:
+            state[ip->target] = values[ip->source];
+            break;
+        case Output:
+            out[ip->target] = values[ip->source];
+            break;
+        case Halt:
+            return;
+        }
+    }
+#endif
+#undef WEIGHT
+}
+
+#undef ACTIVATE
+
+const char *Tape::wavefrontName(Wavefront wavefront)
+{
+    static const char *names[] = {"auto", "always", "never"};
+    return names[wavefront];
+}
+
+bool Tape::isLayered() const
+{
+    return !layers.empty();
+}
+
+void Tape::buildLayers()
+{
+    layers.clear();
+    layerNodes.clear();
+    layerEdges.clear();
+    layerMatrix.clear();
+    if(wavefront == Never || (wavefront == Auto && numEdges() < wavefrontEdges)) {
+        return;
+    }
+
+    auto isTerm = [](Opcode op){return op == Fma || op == Add || op == Recall || op == Store;};
+    auto isActivation = [](Opcode op){return op >= Sigmoid && op <= Identity;};
+
+    // the tape is a sequence of layers, each a run of terms and stores followed by its activations
+    for(size_t i = 0; i < tape.size();) {
+        if(!isTerm(tape[i].op)) {
+            i++;
+            continue;
+        }
+
+        Layer layer;
+        layer.begin = i;
+        layer.first = -1;
+        layer.count = 0;
+
+        // terms of the node that is stored next
+        std::vector<double> constant(1, 0);
+        std::vector<std::vector<LayerEdge>> recurrent(1), forward(1);
+        bool pending = false;
+        for(; i < tape.size() && isTerm(tape[i].op); i++) {
+            const Instruction &instruction = tape[i];
+            pending = instruction.op != Store;
+            switch(instruction.op) {
+            case Add:
+                constant.back() += instruction.weight;
+                break;
+            case Recall:
+                recurrent.back().push_back({instruction.source, instruction.weight});
+                break;
+            case Fma:
+                forward.back().push_back({instruction.source, instruction.weight});
+                break;
+            default:
+                if(layer.first < 0) {
+                    layer.first = instruction.target;
+                }
+                // a tape that isn't laid out by layers runs instruction by instruction
+                if(instruction.target != layer.first + layer.count) {
+                    layers.clear();
+                    return;
+                }
+                layer.count++;
+                constant.push_back(0);
+                recurrent.emplace_back();
+                forward.emplace_back();
+            }
+        }
+        if(pending) {
+            layers.clear();
+            return;
+        }
+
+        layer.activations = i;
+        for(; i < tape.size() && isActivation(tape[i].op); i++) {
+            if(tape[i].target < layer.first || tape[i].target + tape[i].source > layer.first + layer.count) {
+                layers.clear();
+                return;
+            }
+        }
+        layer.end = i;
+
+        // dense when at least a quarter of the matrix over the slots the layer reads is used
+        int lo = int(numValues), hi = 0;
+        size_t numForward = 0;
+        for(auto&& edges : forward) {
+            for(auto&& edge : edges) {
+                lo = std::min(lo, edge.from);
+                hi = std::max(hi, edge.from + 1);
+                numForward++;
+            }
+        }
+        layer.dense = numForward > 0 && hi <= layer.first
+                && size_t(layer.count) * size_t(hi - lo) <= 4 * numForward;
+        layer.lo = layer.dense ? lo : 0;
+        layer.hi = layer.dense ? hi : 0;
+        layer.matrix = layerMatrix.size();
+        layer.nodes = layerNodes.size();
+
+        if(layer.dense) {
+            layerMatrix.resize(layerMatrix.size() + size_t(layer.count) * size_t(hi - lo), 0);
+        }
+        for(int j = 0; j < layer.count; j++) {
+            LayerNode node;
+            node.constant = constant[j];
+            node.edges = int(layerEdges.size());
+            layerEdges.insert(layerEdges.end(), recurrent[j].begin(), recurrent[j].end());
+            node.forward = int(layerEdges.size());
+            if(layer.dense) {
+                for(auto&& edge : forward[j]) {
+                    layerMatrix[layer.matrix + size_t(edge.from - lo) * layer.count + j] += edge.weight;
+                }
+            } else {
+                layerEdges.insert(layerEdges.end(), forward[j].begin(), forward[j].end());
+            }
+            node.end = int(layerEdges.size());
+            layerNodes.push_back(node);
+        }
+        layers.push_back(layer);
+    }
+}
+
+// Activation instruction of a layer
+static void activateLayer(const Tape::Instruction &instruction, double *values)
+{
+    double *first = values + instruction.target;
+    switch(instruction.op) {
+    case Tape::Sigmoid:
+        activateRange<NodeGene::Sigmoid>(first, instruction.source);
+        break;
+    case Tape::Tanh:
+        activateRange<NodeGene::Tanh>(first, instruction.source);
+        break;
+    case Tape::Relu:
+        activateRange<NodeGene::Relu>(first, instruction.source);
+        break;
+    case Tape::Step:
+        activateRange<NodeGene::Step>(first, instruction.source);
+        break;
+    case Tape::Gaussian:
+        activateRange<NodeGene::Gaussian>(first, instruction.source);
+        break;
+    default:
+        break;
+    }
+}
+
+void Tape::runLayers(const double *in, double *out, double *values, double *state) const
+{
+    auto layer = layers.begin();
+    for(size_t i = 0; i < tape.size(); i++) {
+        if(layer != layers.end() && i == layer->begin) {
+            double *sums = values + layer->first;
+            for(int j = 0; j < layer->count; j++) {
+                const LayerNode &node = layerNodes[layer->nodes + j];
+                double sum = node.constant;
+                int e = node.edges;
+                for(; e < node.forward; e++) {
+                    sum += layerEdges[e].weight * state[layerEdges[e].from];
+                }
+                for(; e < node.end; e++) {
+                    sum += layerEdges[e].weight * values[layerEdges[e].from];
+                }
+                sums[j] = sum;
+            }
+
+            // one column per slot read, the inner loop is independent for every node
+            if(layer->dense) {
+                const double *column = layerMatrix.data() + layer->matrix;
+                for(int k = layer->lo; k < layer->hi; k++, column += layer->count) {
+                    double x = values[k];
+                    for(int j = 0; j < layer->count; j++) {
+                        sums[j] += column[j] * x;
+                    }
+                }
+            }
+
+            for(size_t a = layer->activations; a < layer->end; a++) {
+                activateLayer(tape[a], values);
+            }
+            i = layer->end - 1;
+            ++layer;
+            continue;
+        }
+
+        const Instruction &instruction = tape[i];
+        switch(instruction.op) {
+        case Input:
+            values[instruction.target] = in[instruction.source];
+            break;
+        case Constant:
+            values[instruction.target] = instruction.weight;
+            break;
+        case Keep:
+            state[instruction.target] = values[instruction.source];
+            break;
+        case Output:
+            out[instruction.target] = values[instruction.source];
+            break;
+        case Halt:
+            return;
+        default:
+            // terms and activations are part of the layers
+            break;
+        }
+    }
+}
+
+void Tape::reduce()
+{
+    floatWeights.resize(tape.size());
+    quantizedWeights.resize(tape.size());
+
+    // one scale for the tape, the largest weight is 127
+    double largest = 0;
+    for(auto&& instruction : tape) {
+        if(instruction.op == Fma || instruction.op == Add || instruction.op == Recall) {
+            largest = std::max(largest, std::abs(instruction.weight));
+        }
+    }
+    scale = largest > 0 ? float(largest / 127) : 1;
+
+    for(size_t i = 0; i < tape.size(); i++) {
+        bool edge = tape[i].op == Fma || tape[i].op == Add || tape[i].op == Recall;
+        floatWeights[i] = float(tape[i].weight);
+        quantizedWeights[i] = edge ? qint8(std::lround(tape[i].weight / scale)) : 0;
+    }
+}
+
+double Tape::termWeight(const Term &term) const
+{
+    double w = 0;
+    for(int c : term.connections) {
+        w += weights[c];
+    }
+    return w;
+}
+
+void Tape::foldConstants()
+{
+    // evaluated like the tape, so a folded node has exactly the value it would have
+    for(auto&& node : constants) {
+        double sum = 0;
+        for(auto&& term : node.terms) {
+            sum += termWeight(term) * constantValues[term.from];
+        }
+        constantValues[node.node] = NodeGene::activationFunction(node.activation, sum);
+    }
+}
+
+void Tape::patch()
+{
+    for(auto&& p : patches) {
+        Instruction &instruction = tape[p.instruction];
+        if(instruction.op == Constant) {
+            instruction.weight = constantValues[p.term.from];
+        } else if(instruction.op == Add) {
+            instruction.weight = termWeight(p.term) * constantValues[p.term.from];
+        } else {
+            instruction.weight = termWeight(p.term);
+        }
+    }
+    reduce();
+    buildLayers();
+}
+
+bool Tape::hasWeights(const Genome &genome) const
+{
+    for(size_t c = 0; c < weights.size(); c++) {
+        if(weights[c] != genome.connections[c]->weight) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Tape::updateWeights(const Genome &genome)
+{
+    for(size_t c = 0; c < weights.size(); c++) {
+        weights[c] = genome.connections[c]->weight;
+    }
+    foldConstants();
+    patch();
+}
+
+void Tape::write(QDataStream &out) const
+{
+    out << magic << version << qint32(inputs) << qint32(outputs) << quint32(numValues)
+        << quint32(numState);
+
+    out << quint32(tape.size());
+    for(auto&& instruction : tape) {
+        out << quint8(instruction.op) << instruction.target << instruction.source << instruction.weight;
+    }
+}
+
+Tape *Tape::read(QDataStream &in)
+{
+    quint32 fileMagic, fileVersion, numValues, numState, size;
+    qint32 inputs, outputs;
+    in >> fileMagic >> fileVersion;
+    if(fileMagic != magic || fileVersion != version) {
+        return nullptr;
+    }
+    in >> inputs >> outputs >> numValues >> numState >> size;
+
+    Tape *tape = new Tape();
+    tape->inputs = inputs;
+    tape->outputs = outputs;
+    tape->numValues = numValues;
+    tape->numState = numState;
+
+    // every index is checked and the tape has to end with Halt, evaluate trusts it
+    bool valid = inputs >= 0 && outputs >= 0;
+    for(quint32 i = 0; i < size && in.status() == QDataStream::Ok; i++) {
+        quint8 op;
+        Instruction instruction;
+        in >> op >> instruction.target >> instruction.source >> instruction.weight;
+        instruction.op = Opcode(op);
+
+        quint32 target = quint32(instruction.target);
+        quint32 source = quint32(instruction.source);
+        switch(op) {
+        case Input:
+            valid = valid && target < numValues && source < quint32(inputs);
+            break;
+        case Constant:
+        case Store:
+            valid = valid && target < numValues;
+            break;
+        case Sigmoid:
+        case Tanh:
+        case Relu:
+        case Step:
+        case Gaussian:
+        case Identity:
+            valid = valid && target <= numValues && source <= numValues - target;
+            break;
+        case Fma:
+            valid = valid && source < numValues;
+            break;
+        case Recall:
+            valid = valid && source < numState;
+            break;
+        case Keep:
+            valid = valid && target < numState && source < numValues;
+            break;
+        case Output:
+            valid = valid && target < quint32(outputs) && source < numValues;
+            break;
+        case Add:
+        case Halt:
+            break;
+        default:
+            valid = false;
+        }
+        tape->tape.push_back(instruction);
+    }
+    valid = valid && !tape->tape.empty() && tape->tape.back().op == Halt;
+
+    if(!valid || in.status() != QDataStream::Ok) {
+        delete tape;
+        return nullptr;
+    }
+    tape->reduce();
+    tape->buildLayers();
+    return tape;
+}
@@ -0,0 +1,209 @@
+#ifndef TAPE_H
+#define TAPE_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QtGlobal>
+
+class Genome;
+class QDataStream;
+
+// Network of a genome lowered to a linear instruction tape over dense value slots,
+// executed by a small interpreter. Every activated node is a run of multiply-adds
+// into an accumulator, in the same order as Network, that is stored into its slot.
+// The nodes of a layer are grouped by their activation function, so each group is
+// activated by one instruction in a loop without branches.
+//
+// The tape is built by a pipeline of passes over the phenotype: disabled connections
+// are dropped, parallel connections merged into one edge, nodes that don't depend on
+// any input are folded into constants and nodes that don't reach an output are removed.
+// Folding keeps the order of the sums, so the results are identical to
+// Genome::feedForward unless parallel connections were merged.
+//
+// Recurrent connections read the state, the outputs of their nodes in the previous
+// evaluation, which Keep instructions save after all nodes are activated. One pass
+// per evaluation, the state of every episode lives outside of the tape.
+//
+// Genome::tape() keeps the tape of a genome and only rebuilds it when the topology
+// changes, changed weights are written into the existing tape.
+class Tape
+{
+public:
+    // without optimization every enabled connection and every node is evaluated
+    explicit Tape(const Genome &genome, bool optimize = true);
+
+    enum Opcode : quint8
+    {
+        Input,      // values[target] = inputs[source]
+        Constant,   // values[target] = weight
+        Fma,        // sum += weight * values[source]
+        Add,        // sum += weight, a connection from a constant node
+        Recall,     // sum += weight * state[source], a recurrent connection
+        Store,      // values[target] = sum, sum = 0
+        // values[target .. target + source) = f(values[...]), in the order of NodeGene::Activation
+        Sigmoid, Tanh, Relu, Step, Gaussian, Identity,
+        Keep,       // state[target] = values[source]
+        Output,     // outputs[target] = values[source]
+        Halt
+    };
+
+    struct Instruction
+    {
+        Opcode op;
+        qint32 target;
+        qint32 source;
+        double weight;
+    };
+
+    int numInputs() const;
+    int numOutputs() const;
+
+    // Number of values needed by evaluate
+    size_t size() const;
+
+    // Number of values kept between evaluations, the outputs of the sources of recurrent connections
+    size_t stateSize() const;
+
+    const std::vector<Instruction> &instructions() const;
+
+    // Activated nodes and evaluated edges of the tape
+    size_t numActivations() const;
+    size_t numEdges() const;
+
+    // values is a scratch buffer of size() doubles. state holds stateSize() doubles that
+    // belong to one episode: zeroed at its start and passed to every evaluation of it,
+    // it may be nullptr if stateSize() is 0.
+    void evaluate(const double *inputs, double *outputs, double *values, double *state = nullptr) const;
+
+    // Reduced precision: Float evaluates with float weights and values, Int8 also
+    // quantizes the weights to int8 with one scale for the whole tape. Inputs are
+    // converted to float. values and state hold size() and stateSize() floats.
+    enum Precision { Double, Float, Int8 };
+    static const char *precisionName(Precision precision);
+
+    void evaluate(const double *inputs, double *outputs, float *values, float *state,
+                  Precision precision) const;
+
+    // Layer-wavefront evaluation of large tapes in double precision: the sums of all nodes
+    // of a layer are computed together, as a dense matrix-vector product over the slots the
+    // layer reads when the matrix is dense enough, otherwise as sparse rows. The sums are
+    // added in another order, so the outputs can differ from Genome::feedForward in rounding.
+    // Auto uses it for tapes with at least wavefrontEdges edges.
+    enum Wavefront { Auto, Always, Never };
+    static Wavefront wavefront;
+    static const size_t wavefrontEdges = 512;
+    static const char *wavefrontName(Wavefront wavefront);
+
+    bool isLayered() const;
+
+    // Compares and copies the weights of a genome with the topology the tape was built from,
+    // constants depending on them are folded again
+    bool hasWeights(const Genome &genome) const;
+    void updateWeights(const Genome &genome);
+
+    // Serialized tape: magic, version, shape and instructions. Connections of the genome
+    // aren't written, a read tape can be evaluated but not updated.
+    static const quint32 magic = 0x4d525450;    // "MRTP"
+    static const quint32 version = 4;
+
+    void write(QDataStream &out) const;
+    static Tape *read(QDataStream &in);
+
+private:
+    Tape() = default;
+
+    // Connections of the genome merged into one edge from the node from (an index
+    // of genome.nodes), its weight is the sum of their weights
+    struct Term
+    {
+        int from;
+        bool recurrent;
+        std::vector<int> connections;
+    };
+
+    // Node folded into a constant, recomputed when the weights change
+    struct ConstantNode
+    {
+        int node;
+        int activation;
+        std::vector<Term> terms;
+    };
+
+    // Instruction whose weight comes from the genome: Fma and Add get the weight of
+    // the term (times the constant it comes from), Constant the value of the node term.from
+    struct Patch
+    {
+        int instruction;
+        Term term;
+    };
+
+    int inputs;
+    int outputs;
+    size_t numValues;
+    size_t numState;
+    std::vector<Instruction> tape;
+
+    std::vector<double> weights;            // weights of the genome's connections
+    std::vector<ConstantNode> constants;    // in activation order
+    std::vector<double> constantValues;     // by node
+    std::vector<Patch> patches;
+
+    // weights of the instructions in reduced precision, the quantized weight
+    // of Fma and Add is weight / scale
+    std::vector<float> floatWeights;
+    std::vector<qint8> quantizedWeights;
+    float scale;
+
+    double termWeight(const Term &term) const;
+    void foldConstants();
+    void patch();
+    void reduce();
+
+    template<bool quantized>
+    void run(const double *inputs, double *outputs, float *values, float *state) const;
+
+    // Nodes of one layer: the instructions [begin, end) compute the values slots
+    // [first, first + count), activated by the instructions from activations on
+    struct Layer
+    {
+        size_t begin;
+        size_t end;
+        size_t activations;
+        int first;
+        int count;
+        // dense layers read the slots [lo, hi) through a column-major count x (hi - lo)
+        // matrix at layerMatrix[matrix]
+        bool dense;
+        int lo;
+        int hi;
+        size_t matrix;
+        size_t nodes;       // first of its nodes in layerNodes
+    };
+
+    // Sum of one node without the dense part: the constant terms, the recurrent edges
+    // [edges, forward) from the state and the edges [forward, end) from values
+    struct LayerNode
+    {
+        double constant;
+        int edges;
+        int forward;
+        int end;
+    };
+
+    struct LayerEdge
+    {
+        int from;
+        double weight;
+    };
+
+    std::vector<Layer> layers;              // empty if the tape runs instruction by instruction
+    std::vector<LayerNode> layerNodes;
+    std::vector<LayerEdge> layerEdges;
+    std::vector<double> layerMatrix;
+
+    void buildLayers();
+    void runLayers(const double *inputs, double *outputs, double *values, double *state) const;
+};
+
+#endif // TAPE_H
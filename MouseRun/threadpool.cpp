@@ -0,0 +1,131 @@
+#include "threadpool.h"
+
+// index of the worker running on this thread, or -1 for other threads
+static thread_local size_t workerIndex = size_t(-1);
+static thread_local const ThreadPool *workerPool = nullptr;
+
+ThreadPool::ThreadPool(size_t numThreads)
+    : queued{0},
+      nextQueue{0},
+      stopping{false}
+{
+    if(numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for(size_t i = 0; i < numThreads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for(size_t i = 0; i < numThreads; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for(auto &&thread : threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return threads.size();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    // workers keep their own tasks, others are spread round robin
+    size_t index = workerPool == this ? workerIndex : nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wakeUp.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)> &body)
+{
+    std::atomic<size_t> remaining{n};
+
+    for(size_t i = 0; i < n; i++) {
+        submit([this, i, &body, &remaining]() {
+            body(i);
+            if(--remaining == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                taskDone.notify_all();
+            }
+        });
+    }
+
+    size_t index = workerPool == this ? workerIndex : 0;
+    std::function<void()> task;
+    while(remaining > 0) {
+        if(popTask(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        taskDone.wait(lock, [&remaining]() { return remaining == 0; });
+    }
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    workerIndex = index;
+    workerPool = this;
+
+    std::function<void()> task;
+    while(true) {
+        if(popTask(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeUp.wait(lock, [this]() { return stopping || queued > 0; });
+        if(stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::popTask(size_t index, std::function<void()> &task)
+{
+    // newest task of the own queue
+    {
+        Queue &own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    // oldest task of some other queue
+    for(size_t i = 1; i < queues.size(); i++) {
+        Queue &other = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if(!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker has its own queue, takes the newest
+// task from it and steals the oldest task of another worker when it is empty.
+class ThreadPool
+{
+public:
+    // numThreads = 0 uses one thread per core
+    explicit ThreadPool(size_t numThreads = 0);
+    ~ThreadPool();
+
+    size_t size() const;
+
+    void submit(std::function<void()> task);
+
+    // Runs body(0) ... body(n - 1) on the pool and returns when all of them are done.
+    // The calling thread helps with the work while waiting.
+    void parallelFor(size_t n, const std::function<void(size_t)> &body);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable taskDone;
+    std::atomic<size_t> queued;
+    std::atomic<size_t> nextQueue;
+    bool stopping;
+
+    void workerLoop(size_t index);
+
+    // Takes a task from the own queue (index) or steals one from others
+    bool popTask(size_t index, std::function<void()> &task);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,68 @@
+#include "track.h"
+
+#include <random>
+
+const int Track::areaHeight = 400;
+const int Track::halfWidth = 250;
+
+Track::Track(unsigned seed, int numAreas)
+    : trackSeed{seed}
+{
+    std::seed_seq startSeq{seed};
+    std::mt19937 startGen(startSeq);
+    start = std::uniform_int_distribution<>(-200, 199)(startGen);
+
+    for(int n = 0; n < numAreas; n++) {
+        // every area has its own generator, so areas don't depend on each other
+        std::seed_seq seq{seed, unsigned(n) + 1};
+        std::mt19937 gen(seq);
+
+        std::vector<TrackItem> items;
+
+        // 2 mousetraps, 8 pieces of cheese and 2 waterpools
+        for(int i = 0; i < 12; i++) {
+            TrackItem item;
+            item.height = 0;
+            item.width = 0;
+
+            if(i < 2) {
+                item.kind = TrackItem::Trap;
+            } else if(i < 10) {
+                item.kind = TrackItem::Cheese;
+            } else {
+                item.kind = TrackItem::Pool;
+                item.height = std::uniform_int_distribution<>(30, 99)(gen);
+                item.width = std::uniform_int_distribution<>(30, 129)(gen);
+            }
+
+            item.rotation = std::uniform_int_distribution<>(-180, 179)(gen);
+            item.x = std::uniform_int_distribution<>(-halfWidth, halfWidth - 1)(gen);
+            item.offset = std::uniform_int_distribution<>(5, areaHeight - 6)(gen);
+
+            items.push_back(item);
+        }
+        areas.push_back(items);
+    }
+}
+
+unsigned Track::seed() const
+{
+    return trackSeed;
+}
+
+double Track::startX() const
+{
+    return start;
+}
+
+const std::vector<TrackItem>& Track::area(int n) const
+{
+    return areas[n % areas.size()];
+}
+
+unsigned Track::deriveSeed(unsigned baseSeed, int index)
+{
+    std::seed_seq seq{baseSeed, unsigned(index)};
+    std::mt19937 gen(seq);
+    return gen();
+}
@@ -0,0 +1,46 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <vector>
+
+// Description of one item on the course, positions are relative to its area
+struct TrackItem
+{
+    enum Kind { Trap, Cheese, Pool };
+
+    Kind kind;
+    double x;
+    double offset;      // vertical offset inside the area
+    double rotation;
+    double height;      // size of the pool, unused for other items
+    double width;
+};
+
+// Course generated from a seed. All areas are generated in the constructor
+// and never change afterwards, so one track can be shared by many games.
+class Track
+{
+public:
+    Track(unsigned seed, int numAreas = 256);
+
+    unsigned seed() const;
+
+    // Starting x coordinate of every mouse
+    double startX() const;
+
+    // Items of the n-th spawned area, the course repeats after numAreas
+    const std::vector<TrackItem>& area(int n) const;
+
+    // Seed of the index-th track derived from the base seed of the run
+    static unsigned deriveSeed(unsigned baseSeed, int index);
+
+    static const int areaHeight;
+    static const int halfWidth;     // items are spawned in [-halfWidth, halfWidth)
+
+private:
+    unsigned trackSeed;
+    double start;
+    std::vector<std::vector<TrackItem>> areas;
+};
+
+#endif // TRACK_H
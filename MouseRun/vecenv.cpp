@@ -0,0 +1,118 @@
+#include "vecenv.h"
+
+#include <map>
+
+VecEnv::VecEnv(size_t numWorlds, size_t micePerWorld, ThreadPool *pool)
+    : numMice{micePerWorld},
+      pool{pool},
+      worlds(numWorlds),
+      obs(numWorlds * micePerWorld * World::numInputs, 0),
+      reward(numWorlds * micePerWorld, 0),
+      lastFitness(numWorlds * micePerWorld, 0),
+      done(numWorlds * micePerWorld, 1)
+{
+
+}
+
+const double *VecEnv::reset(const std::vector<unsigned> &seeds)
+{
+    // worlds with the same seed share the track
+    std::map<unsigned, std::shared_ptr<const Track>> tracks;
+
+    for(size_t k = 0; k < worlds.size(); k++) {
+        unsigned seed = seeds[k % seeds.size()];
+        if(!tracks.count(seed)) {
+            tracks[seed] = std::make_shared<const Track>(seed);
+        }
+        worlds[k] = std::make_unique<World>(tracks[seed], numMice);
+    }
+
+    std::fill(obs.begin(), obs.end(), 0);
+    std::fill(lastFitness.begin(), lastFitness.end(), 0);
+    for(size_t k = 0; k < worlds.size(); k++) {
+        collect(k);
+    }
+
+    return obs.data();
+}
+
+const double *VecEnv::step(const unsigned char *actions)
+{
+    auto stepWorld = [this, actions](size_t k) {
+        if(!worlds[k]->finished()) {
+            worlds[k]->step(actions + k * numMice);
+            collect(k);
+        } else {
+            std::fill(reward.begin() + k * numMice, reward.begin() + (k + 1) * numMice, 0);
+        }
+    };
+
+    if(pool) {
+        pool->parallelFor(worlds.size(), stepWorld);
+    } else {
+        for(size_t k = 0; k < worlds.size(); k++) {
+            stepWorld(k);
+        }
+    }
+
+    return obs.data();
+}
+
+void VecEnv::collect(size_t k)
+{
+    World &world = *worlds[k];
+    world.observe(obs.data() + k * numMice * World::numInputs);
+
+    for(size_t m = 0; m < numMice; m++) {
+        size_t i = k * numMice + m;
+        double fitness = world.fitness(m);
+        reward[i] = fitness - lastFitness[i];
+        lastFitness[i] = fitness;
+        done[i] = !world.alive(m);
+    }
+}
+
+size_t VecEnv::numWorlds() const
+{
+    return worlds.size();
+}
+
+size_t VecEnv::micePerWorld() const
+{
+    return numMice;
+}
+
+size_t VecEnv::size() const
+{
+    return worlds.size() * numMice;
+}
+
+const double *VecEnv::observations() const
+{
+    return obs.data();
+}
+
+const double *VecEnv::rewards() const
+{
+    return reward.data();
+}
+
+const unsigned char *VecEnv::dones() const
+{
+    return done.data();
+}
+
+bool VecEnv::finished() const
+{
+    for(auto&& world : worlds) {
+        if(world && !world->finished()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const World &VecEnv::world(size_t k) const
+{
+    return *worlds[k];
+}
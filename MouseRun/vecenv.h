@@ -0,0 +1,52 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include <memory>
+#include <vector>
+
+#include "world.h"
+#include "threadpool.h"
+
+// K independent worlds with the same number of mice, stepped in lockstep.
+// Observations, actions, rewards and done flags of all mice are kept in
+// contiguous buffers, mouse m of world k is at row k * micePerWorld + m.
+class VecEnv
+{
+public:
+    // worlds are stepped in parallel if a pool is given
+    VecEnv(size_t numWorlds, size_t micePerWorld, ThreadPool *pool = nullptr);
+
+    // Starts new episodes, world k runs on the track with seeds[k].
+    // Returns the first observations.
+    const double *reset(const std::vector<unsigned> &seeds);
+
+    // actions holds one World::Action mask per mouse, actions of dead mice are ignored.
+    // Returns the next observations.
+    const double *step(const unsigned char *actions);
+
+    size_t numWorlds() const;
+    size_t micePerWorld() const;
+    size_t size() const;                    // number of all mice
+
+    const double *observations() const;     // size() * World::numInputs values
+    const double *rewards() const;          // fitness gained in the last step
+    const unsigned char *dones() const;     // 1 for dead mice
+    bool finished() const;                  // all worlds are finished
+
+    const World &world(size_t k) const;
+
+private:
+    size_t numMice;
+    ThreadPool *pool;
+
+    std::vector<std::unique_ptr<World>> worlds;
+    std::vector<double> obs;
+    std::vector<double> reward;
+    std::vector<double> lastFitness;
+    std::vector<unsigned char> done;
+
+    // updates observations, rewards and done flags of world k
+    void collect(size_t k);
+};
+
+#endif // VECENV_H
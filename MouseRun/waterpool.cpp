@@ -1,4 +1,5 @@
 #include "waterpool.h"
+#include "sprites.h"
 
 #include <QPainter>
 #include <QMovie>
@@ -9,6 +10,7 @@ WaterPool::WaterPool(qreal h, qreal w)
       width(w)
 {
     setZValue(-1);
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 QRectF WaterPool::boundingRect() const
@@ -27,7 +29,7 @@ void WaterPool::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidg
 {
     painter->setPen(Qt::NoPen);
     painter->setRenderHint(QPainter::Antialiasing);
-    painter->setBrush(QBrush(QPixmap(":/img/water1.png")));
+    painter->setBrush(QBrush(Sprites::water()));
     painter->drawEllipse(boundingRect());
 }
 
@@ -46,5 +48,5 @@ QPainterPath WaterBound::shape() const
 void WaterBound::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 {
     painter->setRenderHint(QPainter::Antialiasing);
-    painter->drawTiledPixmap(boundingRect().toRect(), QPixmap(":/img/water1.png"), QPoint(0,0));
+    painter->drawTiledPixmap(boundingRect().toRect(), Sprites::water(), QPoint(0,0));
 }
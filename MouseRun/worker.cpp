@@ -0,0 +1,150 @@
+#include "worker.h"
+#include "tape.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QTimer>
+
+QDataStream &operator<<(QDataStream &out, const World::Limits &limits)
+{
+    return out << qint32(limits.idleTicks) << qint32(limits.tickBudget) << limits.cutoff;
+}
+
+QDataStream &operator>>(QDataStream &in, World::Limits &limits)
+{
+    qint32 idleTicks, tickBudget;
+    in >> idleTicks >> tickBudget >> limits.cutoff;
+    limits.idleTicks = idleTicks;
+    limits.tickBudget = tickBudget;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const Aggregation &aggregation)
+{
+    return out << qint32(aggregation.kind) << aggregation.quantile;
+}
+
+QDataStream &operator>>(QDataStream &in, Aggregation &aggregation)
+{
+    qint32 kind;
+    in >> kind >> aggregation.quantile;
+    aggregation.kind = Aggregation::Kind(kind);
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const EpisodeResult &result)
+{
+    return out << result.fitness << qint32(result.termination) << qint32(result.ticks);
+}
+
+QDataStream &operator>>(QDataStream &in, EpisodeResult &result)
+{
+    qint32 termination, ticks;
+    in >> result.fitness >> termination >> ticks;
+    result.termination = termination;
+    result.ticks = ticks;
+    return in;
+}
+
+Worker::Worker(const QString &serverName, int id, const Options &options)
+    : socket{new QLocalSocket(this)},
+      id{id},
+      pool(options.threads),
+      evaluator(pool, options.worldSize, options.precision)
+{
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readJobs()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+
+    socket->connectToServer(serverName);
+    if(!socket->waitForConnected()) {
+        qWarning() << "Worker" << id << "can't connect to" << serverName;
+        QTimer::singleShot(0, QCoreApplication::instance(), SLOT(quit()));
+        return;
+    }
+
+    QByteArray hello;
+    QDataStream out(&hello, QIODevice::WriteOnly);
+    out << qint32(HelloMessage) << qint32(id);
+
+    QDataStream stream(socket);
+    stream << hello;
+    socket->flush();
+}
+
+void Worker::readJobs()
+{
+    QDataStream stream(socket);
+
+    while(true) {
+        stream.startTransaction();
+        QByteArray message;
+        stream >> message;
+        if(!stream.commitTransaction()) {
+            // wait for the rest of the message
+            return;
+        }
+        runJob(message);
+    }
+}
+
+void Worker::runJob(const QByteArray &message)
+{
+    QDataStream in(message);
+    in.setVersion(QDataStream::Qt_5_10);
+    qint32 type, jobId;
+    QVector<quint32> trackSeeds;
+    World::Limits limits;
+    Aggregation aggregation;
+    quint32 count;
+    in >> type >> jobId >> trackSeeds >> limits >> aggregation >> count;
+    if(type != JobMessage) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<const Track>> jobTracks;
+    for(quint32 seed : trackSeeds) {
+        std::shared_ptr<const Track> track;
+        for(auto&& cached : tracks) {
+            if(cached->seed() == seed) {
+                track = cached;
+            }
+        }
+        if(!track) {
+            track = std::make_shared<const Track>(seed);
+        }
+        jobTracks.push_back(track);
+    }
+    tracks = jobTracks;
+
+    std::vector<std::shared_ptr<const Tape>> tapes;
+    for(quint32 i = 0; i < count; i++) {
+        std::shared_ptr<const Tape> tape(Tape::read(in));
+        if(!tape) {
+            // the coordinator sends the job to another worker
+            qWarning() << "Worker" << id << "received a broken tape in job" << jobId;
+            QCoreApplication::exit(1);
+            return;
+        }
+        tapes.push_back(tape);
+    }
+
+    std::vector<EpisodeResult> results = evaluator.evaluate(tapes, tracks, limits, aggregation);
+
+    QByteArray result;
+    QDataStream out(&result, QIODevice::WriteOnly);
+    out << qint32(ResultMessage) << jobId << quint32(results.size());
+    for(auto&& r : results) {
+        out << r;
+    }
+
+    QDataStream stream(socket);
+    stream << result;
+    socket->flush();
+}
+
+void Worker::disconnected()
+{
+    // coordinator is gone
+    QCoreApplication::quit();
+}
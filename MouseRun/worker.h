@@ -0,0 +1,57 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <memory>
+#include <QObject>
+#include <QDataStream>
+#include <QLocalSocket>
+
+#include "options.h"
+#include "threadpool.h"
+#include "evaluator.h"
+#include "track.h"
+#include "world.h"
+
+// Messages exchanged between the coordinator (WorkerPool) and worker processes.
+// Every message is a QByteArray written with QDataStream, starting with its type.
+//  HelloMessage:  worker id
+//  JobMessage:    job id, track seeds (one per episode), limits (idle ticks, tick budget,
+//                 cutoff), aggregation (kind, quantile), number of genomes, tapes of the genomes (Tape::write)
+//  ResultMessage: job id, number of genomes, fitness, termination and ticks of every genome
+enum WorkerMessage : qint32 { HelloMessage, JobMessage, ResultMessage };
+
+QDataStream &operator<<(QDataStream &out, const World::Limits &limits);
+QDataStream &operator>>(QDataStream &in, World::Limits &limits);
+QDataStream &operator<<(QDataStream &out, const Aggregation &aggregation);
+QDataStream &operator>>(QDataStream &in, Aggregation &aggregation);
+QDataStream &operator<<(QDataStream &out, const EpisodeResult &result);
+QDataStream &operator>>(QDataStream &in, EpisodeResult &result);
+
+// Worker process mode (--worker). Connects to the coordinator over a local socket,
+// evaluates the received jobs headless and sends back the fitness.
+class Worker : public QObject
+{
+    Q_OBJECT
+
+public:
+    Worker(const QString &serverName, int id, const Options &options);
+
+private slots:
+    void readJobs();
+
+    void disconnected();
+
+private:
+    QLocalSocket *socket;
+    int id;
+
+    ThreadPool pool;
+    Evaluator evaluator;
+
+    // tracks of the last job, jobs of one generation share them
+    std::vector<std::shared_ptr<const Track>> tracks;
+
+    void runJob(const QByteArray &message);
+};
+
+#endif // WORKER_H
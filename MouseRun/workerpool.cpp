@@ -0,0 +1,287 @@
+#include "workerpool.h"
+#include "tape.h"
+#include "worker.h"
+
+#include <algorithm>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+
+// jobs sent to a worker before it answers
+const int maxInFlight = 2;
+// a job that crashed this many workers is given up
+const int maxAttempts = 3;
+const int maxRestarts = 10;
+
+WorkerPool::WorkerPool(int numWorkers, const Options &options, QObject *parent)
+    : QObject(parent),
+      server{new QLocalServer(this)},
+      options{options},
+      jobsLeft{0}
+{
+    connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+
+    QString name = QString("MouseRun-%1").arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(name);
+    if(!server->listen(name)) {
+        qWarning() << "Can't listen on" << name << server->errorString();
+    }
+
+    // cores are divided between the workers
+    if(this->options.threads == 0) {
+        this->options.threads = std::max(1, QThread::idealThreadCount() / numWorkers);
+    }
+
+    workers.resize(numWorkers);
+    for(int i = 0; i < numWorkers; i++) {
+        workers[i].process = nullptr;
+        workers[i].socket = nullptr;
+        workers[i].restarts = 0;
+        startWorker(i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    for(auto&& worker : workers) {
+        if(worker.process) {
+            worker.process->disconnect(this);
+            worker.process->kill();
+            worker.process->waitForFinished();
+        }
+    }
+}
+
+void WorkerPool::startWorker(int id)
+{
+    QProcess *process = new QProcess(this);
+    process->setProperty("workerId", id);
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+
+    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)),
+            this, SLOT(workerFinished(int, QProcess::ExitStatus)));
+    connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)),
+            this, SLOT(workerError(QProcess::ProcessError)));
+
+    workers[id].process = process;
+    process->start(QCoreApplication::applicationFilePath(),
+                   {"--worker", server->serverName(),
+                    "--worker-id", QString::number(id),
+                    "--threads", QString::number(options.threads),
+                    "--world-size", QString::number(options.worldSize),
+                    "--precision", Tape::precisionName(options.precision),
+                    "--wavefront", Tape::wavefrontName(options.wavefront),
+                    "--sensors", Sensors::encodingName(options.sensors.encoding),
+                    "--rays", QString::number(options.sensors.rays),
+                    "--field-of-view", QString::number(options.sensors.fieldOfView),
+                    "--ray-range", QString::number(options.sensors.range)});
+}
+
+void WorkerPool::evaluate(const std::vector<Genome*> &genomes, const std::vector<unsigned> &trackSeeds,
+                          const World::Limits &limits, const Aggregation &aggregation, size_t jobSize)
+{
+    this->genomes = genomes;
+    this->trackSeeds.clear();
+    for(unsigned seed : trackSeeds) {
+        this->trackSeeds.push_back(seed);
+    }
+    this->limits = limits;
+    this->aggregation = aggregation;
+    jobResults.assign(genomes.size(), EpisodeResult{0, World::Trapped, 0});
+
+    jobs.clear();
+    queue.clear();
+    for(size_t first = 0; first < genomes.size(); first += jobSize) {
+        Job job;
+        job.first = first;
+        job.count = std::min(jobSize, genomes.size() - first);
+        job.attempts = 0;
+        job.done = false;
+        queue.push_back(int(jobs.size()));
+        jobs.push_back(job);
+    }
+    jobsLeft = jobs.size();
+
+    dispatch();
+}
+
+void WorkerPool::dispatch()
+{
+    for(auto&& worker : workers) {
+        if(!worker.socket) {
+            continue;
+        }
+
+        while(!queue.empty() && worker.inFlight.size() < maxInFlight) {
+            int jobId = queue.front();
+            queue.pop_front();
+            const Job &job = jobs[jobId];
+
+            // serialized here, while the worker is busy with its previous job
+            QByteArray message;
+            QDataStream out(&message, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_5_10);
+            out << qint32(JobMessage) << qint32(jobId) << trackSeeds << limits << aggregation
+                << quint32(job.count);
+            for(size_t i = job.first; i < job.first + job.count; i++) {
+                genomes[i]->tape()->write(out);
+            }
+
+            QDataStream stream(worker.socket);
+            stream << message;
+            worker.inFlight.push_back(jobId);
+        }
+        worker.socket->flush();
+    }
+}
+
+void WorkerPool::newConnection()
+{
+    while(QLocalSocket *socket = server->nextPendingConnection()) {
+        socket->setParent(this);
+        socket->setProperty("workerId", -1);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readResults()));
+    }
+}
+
+void WorkerPool::readResults()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    QDataStream stream(socket);
+
+    while(true) {
+        stream.startTransaction();
+        QByteArray message;
+        stream >> message;
+        if(!stream.commitTransaction()) {
+            break;
+        }
+
+        QDataStream in(message);
+        qint32 type, value;
+        in >> type >> value;
+
+        if(type == HelloMessage) {
+            // the worker tells which process it is
+            if(value >= 0 && value < int(workers.size())) {
+                socket->setProperty("workerId", value);
+                workers[value].socket = socket;
+            }
+        } else if(type == ResultMessage) {
+            quint32 count;
+            in >> count;
+            std::vector<EpisodeResult> result(count);
+            for(auto&& r : result) {
+                in >> r;
+            }
+
+            int id = workerOf(socket);
+            if(id >= 0) {
+                auto &inFlight = workers[id].inFlight;
+                inFlight.erase(std::remove(inFlight.begin(), inFlight.end(), value), inFlight.end());
+            }
+            completeJob(value, result);
+        }
+    }
+
+    dispatch();
+}
+
+const std::vector<EpisodeResult> &WorkerPool::results() const
+{
+    return jobResults;
+}
+
+void WorkerPool::completeJob(int jobId, const std::vector<EpisodeResult> &result)
+{
+    if(jobId < 0 || jobId >= int(jobs.size()) || jobs[jobId].done) {
+        return;
+    }
+
+    Job &job = jobs[jobId];
+    job.done = true;
+    for(size_t i = 0; i < job.count && i < result.size(); i++) {
+        jobResults[job.first + i] = result[i];
+    }
+
+    // queued, the receiver starts the next evaluation and must not run inside our loops
+    if(--jobsLeft == 0) {
+        QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+    }
+}
+
+void WorkerPool::requeue(int id)
+{
+    WorkerProcess &worker = workers[id];
+
+    // the worker is detached first, no job can be sent to it from now on
+    std::deque<int> inFlight;
+    inFlight.swap(worker.inFlight);
+    if(worker.socket) {
+        worker.socket->disconnect(this);
+        worker.socket->deleteLater();
+        worker.socket = nullptr;
+    }
+
+    // newest jobs go back first, so the order of the queue is kept
+    for(auto it = inFlight.rbegin(); it != inFlight.rend(); ++it) {
+        Job &job = jobs[*it];
+        if(job.done) {
+            continue;
+        }
+
+        if(++job.attempts >= maxAttempts) {
+            qWarning() << "Job" << *it << "crashed" << job.attempts << "workers, its genomes get fitness 0";
+            completeJob(*it, std::vector<EpisodeResult>(job.count, EpisodeResult{0, World::Trapped, 0}));
+        } else {
+            queue.push_front(*it);
+        }
+    }
+}
+
+void WorkerPool::workerFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    int id = workerOf(sender());
+    if(id < 0) {
+        return;
+    }
+    qWarning() << "Worker" << id << "stopped, exit code" << exitCode
+               << (exitStatus == QProcess::CrashExit ? "(crashed)" : "");
+
+    requeue(id);
+    workers[id].process->deleteLater();
+    workers[id].process = nullptr;
+
+    if(++workers[id].restarts <= maxRestarts) {
+        startWorker(id);
+    } else {
+        qWarning() << "Worker" << id << "restarted too many times, giving up on it";
+    }
+
+    // queued jobs would wait forever without any worker
+    bool anyWorker = std::any_of(workers.begin(), workers.end(),
+                                 [](const WorkerProcess &worker){ return worker.process != nullptr; });
+    if(!anyWorker) {
+        qCritical() << "All workers failed," << jobsLeft << "jobs can't be evaluated, stopping the run";
+        QCoreApplication::exit(1);
+        return;
+    }
+
+    dispatch();
+}
+
+void WorkerPool::workerError(QProcess::ProcessError error)
+{
+    // a process that never started doesn't emit finished
+    if(error == QProcess::FailedToStart) {
+        workerFinished(-1, QProcess::CrashExit);
+    }
+}
+
+int WorkerPool::workerOf(QObject *object) const
+{
+    return object ? object->property("workerId").toInt() : -1;
+}
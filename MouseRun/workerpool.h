@@ -0,0 +1,92 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <deque>
+#include <vector>
+#include <QObject>
+#include <QProcess>
+#include <QVector>
+
+#include "genome.h"
+#include "options.h"
+#include "world.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// Coordinator of worker processes (--workers). Starts the workers, splits the genomes
+// into jobs and sends them over local sockets. Every worker gets the next job while it
+// is still evaluating the current one, so serialization overlaps with evaluation.
+// Jobs of a crashed worker are queued again and the worker is restarted. The run stops
+// with an error when every worker was restarted too many times.
+class WorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    WorkerPool(int numWorkers, const Options &options, QObject *parent = nullptr);
+    ~WorkerPool();
+
+    // Genomes must stay alive until finished is emitted
+    void evaluate(const std::vector<Genome*> &genomes, const std::vector<unsigned> &trackSeeds,
+                  const World::Limits &limits, const Aggregation &aggregation, size_t jobSize);
+
+    // results()[i] belongs to genomes[i], valid after finished
+    const std::vector<EpisodeResult> &results() const;
+
+signals:
+    void finished();
+
+private slots:
+    void newConnection();
+
+    void readResults();
+
+    void workerFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void workerError(QProcess::ProcessError error);
+
+private:
+    struct Job
+    {
+        size_t first;       // index of the first genome
+        size_t count;
+        int attempts;
+        bool done;
+    };
+
+    struct WorkerProcess
+    {
+        QProcess *process;
+        QLocalSocket *socket;
+        std::deque<int> inFlight;
+        int restarts;
+    };
+
+    QLocalServer *server;
+    Options options;
+    std::vector<WorkerProcess> workers;
+
+    std::vector<Genome*> genomes;
+    QVector<quint32> trackSeeds;
+    World::Limits limits;
+    Aggregation aggregation;
+    std::vector<Job> jobs;
+    std::deque<int> queue;
+    size_t jobsLeft;
+    std::vector<EpisodeResult> jobResults;
+
+    void startWorker(int id);
+
+    // Sends queued jobs to connected workers
+    void dispatch();
+
+    // Puts jobs of a dead worker back to the queue
+    void requeue(int id);
+
+    void completeJob(int jobId, const std::vector<EpisodeResult> &result);
+
+    int workerOf(QObject *object) const;
+};
+
+#endif // WORKERPOOL_H
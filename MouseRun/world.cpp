@@ -0,0 +1,910 @@
+#include "world.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+// Speeds of the mice and the cat
+static const int maxSpeed = 6;
+static const double turningAngle = 0.5;
+static const double consumption = 0.01;
+static const double catSpeed = 5;
+static const double startY = -300;
+
+// Water bounds cover x in [boundX - boundW/2, boundX + boundW/2] on both sides
+static const double boundX = 500;
+static const double boundW = 500;
+
+static const double degToRad = M_PI / 180;
+
+// Side of the cells of the item grid used by the rays
+static const double cellSize = 64;
+
+// Input of a ray for the kind it hit, indexed by Item::Kind
+static const double rayKindCode[] = { -0.5, -0.25, -1, 1 };
+
+// The most a mouse can gain in one tick: full speed, full rotation and advanceBonus counted
+// twice, from moving forward, eating all cheese of an area and seeing cheese or obstacles
+static const double maxBonusPerTick = 1 + 8 + 3;
+static const double maxGainPerTick = maxSpeed + 20 * std::sin(turningAngle) + 2 * maxBonusPerTick;
+
+Aggregation::Aggregation(Kind kind, double quantile)
+    : kind{kind},
+      quantile{quantile}
+{
+
+}
+
+EpisodeResult Aggregation::combine(const EpisodeResult *episodes, size_t n) const
+{
+    EpisodeResult result;
+    result.ticks = 0;
+
+    size_t worst = 0;
+    double sum = 0;
+    std::vector<double> fitness(n);
+    for(size_t e = 0; e < n; e++) {
+        fitness[e] = episodes[e].fitness;
+        sum += fitness[e];
+        result.ticks += episodes[e].ticks;
+        if(fitness[e] < fitness[worst]) {
+            worst = e;
+        }
+    }
+    result.termination = episodes[worst].termination;
+
+    if(kind == Min) {
+        result.fitness = fitness[worst];
+    } else if(kind == Quantile) {
+        // linear interpolation between the closest ranks
+        std::sort(fitness.begin(), fitness.end());
+        double position = std::min(std::max(quantile, 0.0), 1.0) * (n - 1);
+        size_t below = size_t(position);
+        size_t above = std::min(below + 1, n - 1);
+        result.fitness = fitness[below] + (position - below) * (fitness[above] - fitness[below]);
+    } else {
+        result.fitness = sum / n;
+    }
+    return result;
+}
+
+Sensors::Sensors()
+    : encoding{Legacy},
+      rays{9},
+      fieldOfView{180},
+      range{300}
+{
+
+}
+
+int Sensors::numInputs() const
+{
+    if(encoding == Rays) {
+        return 2 * rays;
+    }
+    return encoding == Egocentric ? 11 : 12;
+}
+
+const char *Sensors::encodingName(Encoding encoding)
+{
+    static const char *names[] = {"legacy", "rays", "egocentric"};
+    return names[encoding];
+}
+
+Sensors World::sensorConfig;
+int World::numInputs = 12;
+
+const Sensors &World::sensors()
+{
+    return sensorConfig;
+}
+
+void World::setSensors(const Sensors &sensors)
+{
+    sensorConfig = sensors;
+    numInputs = sensors.numInputs();
+}
+
+World::Limits::Limits()
+    : idleTicks{0},
+      tickBudget{0},
+      cutoff{0}
+{
+
+}
+
+const char *World::terminationName(int termination)
+{
+    switch(termination) {
+    case Running:   return "running";
+    case Caught:    return "caught";
+    case Trapped:   return "trapped";
+    case Idle:      return "idle";
+    case Hopeless:  return "hopeless";
+    case Budget:    return "budget";
+    }
+    return "unknown";
+}
+
+void World::MiceState::resize(size_t n)
+{
+    x.resize(n);
+    y.resize(n);
+    heading.resize(n);
+    speed.resize(n);
+    traveled.resize(n);
+    rotated.resize(n);
+    fitness.resize(n);
+    bestY.resize(n);
+    lastProgress.resize(n);
+    endTick.resize(n);
+    termination.resize(n);
+    advanceBonus.resize(n);
+    inWater.resize(n);
+    alive.resize(n);
+    actions.resize(n);
+    mouse.resize(n);
+    slotOf.resize(n);
+    bonusDelta.resize(n);
+    ateCheese.resize(n);
+}
+
+void World::MiceState::swap(size_t a, size_t b)
+{
+    std::swap(x[a], x[b]);
+    std::swap(y[a], y[b]);
+    std::swap(heading[a], heading[b]);
+    std::swap(speed[a], speed[b]);
+    std::swap(traveled[a], traveled[b]);
+    std::swap(rotated[a], rotated[b]);
+    std::swap(fitness[a], fitness[b]);
+    std::swap(bestY[a], bestY[b]);
+    std::swap(lastProgress[a], lastProgress[b]);
+    std::swap(endTick[a], endTick[b]);
+    std::swap(termination[a], termination[b]);
+    std::swap(advanceBonus[a], advanceBonus[b]);
+    std::swap(inWater[a], inWater[b]);
+    std::swap(alive[a], alive[b]);
+    std::swap(actions[a], actions[b]);
+    std::swap(mouse[a], mouse[b]);
+    slotOf[mouse[a]] = int(a);
+    slotOf[mouse[b]] = int(b);
+}
+
+World::World(std::shared_ptr<const Track> track, size_t numMice, const Limits &limits)
+    : track{track},
+      limits{limits},
+      gridLeft{0},
+      gridTop{0},
+      gridColumns{0},
+      gridRows{0},
+      gridChanged{true},
+      rayStamp{0},
+      catY{0},
+      nextArea{0},
+      numOfAlive{numMice},
+      tick{0}
+{
+    mice.resize(numMice);
+    for(size_t i = 0; i < numMice; i++) {
+        mice.x[i] = track->startX();
+        mice.y[i] = startY;
+        mice.heading[i] = 0;
+        mice.speed[i] = 5;
+        mice.traveled[i] = 0;
+        mice.rotated[i] = 0;
+        mice.fitness[i] = 0;
+        mice.bestY[i] = startY;
+        mice.lastProgress[i] = 0;
+        mice.endTick[i] = 0;
+        mice.termination[i] = Running;
+        mice.advanceBonus[i] = 0;
+        mice.inWater[i] = false;
+        mice.alive[i] = true;
+        mice.actions[i] = 0;
+        mice.mouse[i] = int(i);
+        mice.slotOf[i] = int(i);
+    }
+
+    spawnAreas();
+}
+
+size_t World::numMice() const
+{
+    return mice.x.size();
+}
+
+size_t World::numAlive() const
+{
+    return numOfAlive;
+}
+
+bool World::finished() const
+{
+    return numOfAlive == 0;
+}
+
+int World::ticks() const
+{
+    return tick;
+}
+
+int World::aliveMouse(size_t k) const
+{
+    return mice.mouse[k];
+}
+
+bool World::alive(size_t i) const
+{
+    return mice.alive[mice.slotOf[i]];
+}
+
+double World::fitness(size_t i) const
+{
+    size_t slot = mice.slotOf[i];
+    return mice.alive[slot] ? calcFitness(slot) : mice.fitness[slot];
+}
+
+EpisodeResult World::result(size_t i) const
+{
+    size_t slot = mice.slotOf[i];
+    EpisodeResult result;
+    result.fitness = fitness(i);
+    result.termination = mice.termination[slot];
+    result.ticks = mice.alive[slot] ? tick : mice.endTick[slot];
+    return result;
+}
+
+double World::mouseX(size_t i) const
+{
+    return mice.x[mice.slotOf[i]];
+}
+
+double World::mouseY(size_t i) const
+{
+    return mice.y[mice.slotOf[i]];
+}
+
+double World::heading(size_t i) const
+{
+    return mice.heading[mice.slotOf[i]];
+}
+
+double World::catPosition() const
+{
+    return catY;
+}
+
+int World::spawnedAreas() const
+{
+    return nextArea;
+}
+
+double World::areaTop(int n)
+{
+    // the first area is spawned in front of the mice, as the second area of the original game
+    return -(n + 2) * Track::areaHeight;
+}
+
+unsigned char World::decide(const double *outputs)
+{
+    unsigned char keys = 0;
+    if(outputs[0] >= 0.5) keys |= Forward;
+    if(outputs[1] >= 0.5) keys |= Left;
+    if(outputs[2] >= 0.5) keys |= Backward;
+    if(outputs[3] >= 0.5) keys |= Right;
+    return keys;
+}
+
+void World::observe(double *inputs)
+{
+    // the advance bonus is part of the fitness, so every encoding gets it from the legacy
+    // fields of vision, the legacy sensors report the same fields
+    if(sensorConfig.encoding == Sensors::Rays) {
+        observeRays(inputs);
+        addSightBonus();
+    } else if(sensorConfig.encoding == Sensors::Egocentric) {
+        observeEgocentric(inputs);
+        addSightBonus();
+    } else {
+        observeLegacy(inputs);
+    }
+}
+
+void World::lookAround(size_t slot, Item seen[3], int kinds[3]) const
+{
+    double x = mice.x[slot];
+    double y = mice.y[slot];
+    double heading = mice.heading[slot];
+
+    // fields of vision in front, on the left and on the right of the mouse
+    Polygon fields[3] = {
+        rectangle(-20, -70, 40, 70, x, y, heading),
+        rectangle(-60, -50, 40, 50, x, y, heading),
+        rectangle(20, -50, 40, 50, x, y, heading)
+    };
+
+    for(int f = 0; f < 3; f++) {
+        kinds[f] = look(fields[f], y, seen[f]) ? seen[f].kind : -1;
+    }
+}
+
+void World::addSightBonus()
+{
+    for(size_t slot = 0; slot < numOfAlive; slot++) {
+        Item seen[3];
+        int kinds[3];
+        lookAround(slot, seen, kinds);
+        addSightBonus(slot, kinds);
+    }
+}
+
+void World::observeLegacy(double *inputs)
+{
+    for(size_t slot = 0; slot < numOfAlive; slot++) {
+        double *in = inputs + mice.mouse[slot] * numInputs;
+        int n = 0;
+
+        in[n++] = mice.x[slot];
+        in[n++] = mice.y[slot] - catY;
+
+        double rot = std::fmod(mice.heading[slot], 360);
+        if(rot > 180){
+            rot = -( 360 - rot);
+        }else if(rot < -180){
+            rot = 360 + rot;
+        }
+        in[n++] = rot;
+
+        Item seen[3];
+        int kinds[3];
+        lookAround(slot, seen, kinds);
+        for(int f = 0; f < 3; f++) {
+            if(kinds[f] < 0) {
+                continue;
+            }
+            if(seen[f].kind == Item::Cheese) {
+                in[n++] = 100;
+            } else {
+                in[n++] = seen[f].kind == Item::Trap ? -100 : -10;
+            }
+            in[n++] = seen[f].x;
+            in[n++] = seen[f].y - catY;
+        }
+        addSightBonus(slot, kinds);
+
+        while(n < numInputs) {
+            in[n++] = 0;
+        }
+    }
+}
+
+void World::observeRays(double *inputs)
+{
+    if(gridChanged) {
+        buildGrid();
+    }
+
+    const int rays = sensorConfig.rays;
+    const double range = sensorConfig.range;
+
+    // offsets of the rays from the heading, the same for every mouse
+    std::vector<double> offsets(rays);
+    for(int r = 0; r < rays; r++) {
+        offsets[r] = rays > 1 ? sensorConfig.fieldOfView * (double(r) / (rays - 1) - 0.5) : 0;
+    }
+
+    for(size_t slot = 0; slot < numOfAlive; slot++) {
+        double *in = inputs + mice.mouse[slot] * numInputs;
+        double x = mice.x[slot];
+        double y = mice.y[slot];
+        double heading = mice.heading[slot];
+
+        for(int r = 0; r < rays; r++) {
+            double rad = (heading + offsets[r]) * degToRad;
+            int kind;
+            double distance = castRay(x, y, std::sin(rad), -std::cos(rad), range, kind);
+            in[2 * r] = distance / range;
+            in[2 * r + 1] = kind >= 0 ? rayKindCode[kind] : 0;
+        }
+    }
+}
+
+void World::observeEgocentric(double *inputs)
+{
+    const size_t n = numOfAlive;
+    const double range = sensorConfig.range;
+    const double *x = mice.x.data();
+    const double *y = mice.y.data();
+
+    // kinds of items reported, in the order of their inputs
+    const int kinds[3] = { Item::Cheese, Item::Trap, Item::Pool };
+
+    double top = 0;
+    double bottom = 0;
+    for(size_t slot = 0; slot < n; slot++) {
+        top = slot ? std::min(top, y[slot]) : y[slot];
+        bottom = slot ? std::max(bottom, y[slot]) : y[slot];
+    }
+
+    const double none = std::numeric_limits<double>::infinity();
+    for(int k = 0; k < 3; k++) {
+        nearestDistance[k].assign(n, none);
+        nearestX[k].resize(n);
+        nearestY[k].resize(n);
+    }
+
+    // one pass over the items within range of any mouse, the inner loop over the mice has
+    // no branches so the compiler can vectorize it
+    for(const Item &item : items) {
+        if(item.kind == Item::Bound || item.y < top - range || item.y > bottom + range) {
+            continue;
+        }
+        int k = int(std::find(kinds, kinds + 3, item.kind) - kinds);
+        double *distance = nearestDistance[k].data();
+        double *nx = nearestX[k].data();
+        double *ny = nearestY[k].data();
+        const double ix = item.x;
+        const double iy = item.y;
+        for(size_t slot = 0; slot < n; slot++) {
+            double d = (ix - x[slot]) * (ix - x[slot]) + (iy - y[slot]) * (iy - y[slot]);
+            bool closer = d < distance[slot];
+            distance[slot] = closer ? d : distance[slot];
+            nx[slot] = closer ? ix : nx[slot];
+            ny[slot] = closer ? iy : ny[slot];
+        }
+    }
+
+    for(size_t slot = 0; slot < n; slot++) {
+        double *in = inputs + mice.mouse[slot] * numInputs;
+        double rad = mice.heading[slot] * degToRad;
+        double forwardX = std::sin(rad);
+        double forwardY = -std::cos(rad);
+
+        // the cat is behind (larger y), the bounds are on the sides
+        double cat = catY - y[slot];
+        double left = x[slot] - (-boundX + boundW/2);
+        double right = boundX - boundW/2 - x[slot];
+
+        in[0] = forwardX;
+        in[1] = forwardY;
+        in[2] = std::min(std::max(cat / range, 0.0), 1.0);
+        in[3] = std::min(std::max(left / range, 0.0), 1.0);
+        in[4] = std::min(std::max(right / range, 0.0), 1.0);
+
+        for(int k = 0; k < 3; k++) {
+            double distance = std::sqrt(nearestDistance[k][slot]);
+            if(distance > range) {
+                // nothing within range: far away, straight ahead
+                in[5 + 2 * k] = 1;
+                in[6 + 2 * k] = 0;
+                continue;
+            }
+
+            double dx = nearestX[k][slot] - x[slot];
+            double dy = nearestY[k][slot] - y[slot];
+            double ahead = dx * forwardX + dy * forwardY;
+            double side = dx * -forwardY + dy * forwardX;
+            double bearing = std::atan2(side, ahead) / degToRad;
+            in[5 + 2 * k] = distance / range;
+            in[6 + 2 * k] = bearing / 180;
+        }
+    }
+}
+
+void World::addSightBonus(size_t slot, const int kinds[3])
+{
+    for(int sector = 0; sector < 3; sector++) {
+        if(kinds[sector] == Item::Cheese) {
+            mice.advanceBonus[slot] += sector == 0;
+        } else if(kinds[sector] >= 0) {
+            mice.advanceBonus[slot] += sector == 0 ? -1 : 1;
+        }
+    }
+}
+
+void World::step(const unsigned char *actions)
+{
+    for(size_t slot = 0; slot < numOfAlive; slot++) {
+        mice.actions[slot] = actions[mice.mouse[slot]];
+    }
+
+    collide();
+    move();
+    removeDead();
+
+    // Move the cat
+    catY -= catSpeed;
+
+    spawnAreas();
+    deleteItems();
+    tick++;
+}
+
+void World::collide()
+{
+    for(size_t slot = 0; slot < numOfAlive; slot++) {
+        int bonus = 0;
+        bool cheese = false;
+        bool water = false;
+
+        Polygon body = rectangle(-10, -20, 20, 40, mice.x[slot], mice.y[slot], mice.heading[slot]);
+        for(const Item &item : items) {
+            if(!intersects(body, item.shape)) {
+                continue;
+            }
+
+            if(item.kind == Item::Cheese) {
+                bonus++;
+                cheese = true;
+            } else if(item.kind == Item::Trap) {
+                mice.alive[slot] = false;
+            } else {
+                water = true;
+                bonus--;
+            }
+        }
+
+        // water bounds on both sides
+        double minX = body.minX();
+        double maxX = body.maxX();
+        if(maxX >= -boundX - boundW/2 && minX <= -boundX + boundW/2) {
+            water = true;
+            bonus--;
+        }
+        if(maxX >= boundX - boundW/2 && minX <= boundX + boundW/2) {
+            water = true;
+            bonus--;
+        }
+
+        mice.bonusDelta[slot] = bonus;
+        mice.ateCheese[slot] = cheese;
+        mice.inWater[slot] = water;
+    }
+}
+
+void World::move()
+{
+    double *x = mice.x.data();
+    double *y = mice.y.data();
+    double *heading = mice.heading.data();
+    double *speed = mice.speed.data();
+    double *traveled = mice.traveled.data();
+    double *rotated = mice.rotated.data();
+    int *advanceBonus = mice.advanceBonus.data();
+    const unsigned char *inWater = mice.inWater.data();
+    const unsigned char *actions = mice.actions.data();
+    const unsigned char *ateCheese = mice.ateCheese.data();
+    const int *bonusDelta = mice.bonusDelta.data();
+    double *bestY = mice.bestY.data();
+    int *lastProgress = mice.lastProgress.data();
+    const int now = tick;
+
+    // no branches depend on the data, so the loop can be vectorized
+    for(size_t s = 0; s < numOfAlive; s++) {
+        // energy is lost over time, cheese restores it
+        double v = speed[s] > maxSpeed/2 ? speed[s] - consumption : speed[s];
+        v = ateCheese[s] ? maxSpeed : v;
+        speed[s] = v;
+
+        bool w = actions[s] & Forward;
+        bool a = actions[s] & Left;
+        bool b = actions[s] & Backward;
+        bool d = actions[s] & Right;
+        bool water = inWater[s];
+
+        // forward at full speed, backward at half speed, only paddling forward in water
+        bool forward = w && !b;
+        bool backward = b && !w;
+        double distance = forward ? (water ? 1 : v) : (backward ? (water ? 1 : -v/2) : 0);
+        bool advancing = forward && !water;
+
+        double rad = heading[s] * degToRad;
+        x[s] += distance * std::sin(rad);
+        y[s] -= distance * std::cos(rad);
+        traveled[s] += advancing ? v : 0;
+        lastProgress[s] = y[s] < bestY[s] ? now : lastProgress[s];
+        bestY[s] = std::min(bestY[s], y[s]);
+        advanceBonus[s] += bonusDelta[s] + advancing;
+
+        // rotation is slower in water
+        double direction = double(d && !a) - double(a && !d);
+        double angle = direction * (water ? 0.1 : turningAngle);
+        double dx = std::sin(angle) * 20;
+        heading[s] += dx;
+        rotated[s] += std::abs(dx);
+    }
+}
+
+void World::removeDead()
+{
+    bool outOfTime = limits.tickBudget > 0 && tick + 1 >= limits.tickBudget;
+    bool checkHopeless = limits.tickBudget > 0 && limits.cutoff > 0;
+
+    size_t slot = 0;
+    while(slot < numOfAlive) {
+        Termination termination = Running;
+
+        if(!mice.alive[slot]) {
+            termination = Trapped;
+        } else if(mice.y[slot] >= catY) {
+            termination = Caught;
+        } else if(outOfTime) {
+            termination = Budget;
+        } else if(limits.idleTicks > 0 && tick - mice.lastProgress[slot] >= limits.idleTicks) {
+            termination = Idle;
+        } else if(checkHopeless && fitnessUpperBound(slot) < limits.cutoff) {
+            termination = Hopeless;
+        }
+
+        if(termination == Running) {
+            slot++;
+            continue;
+        }
+
+        mice.alive[slot] = false;
+        mice.termination[slot] = termination;
+        mice.endTick[slot] = tick + 1;
+        mice.fitness[slot] = calcFitness(slot);
+        mice.swap(slot, --numOfAlive);
+    }
+}
+
+double World::fitnessUpperBound(size_t slot) const
+{
+    double bonus = std::max(0, mice.advanceBonus[slot]);
+    double remaining = limits.tickBudget - tick - 1;
+    return mice.traveled[slot] + mice.rotated[slot] + 2 * bonus + remaining * maxGainPerTick;
+}
+
+double World::calcFitness(size_t slot) const
+{
+    double fitness = 0;
+
+    if(mice.rotated[slot]){
+        fitness += mice.advanceBonus[slot];
+    }
+
+    if(mice.traveled[slot]){
+        fitness += mice.advanceBonus[slot];
+    }
+
+    fitness += mice.traveled[slot];
+    fitness += mice.rotated[slot];
+
+    return fitness >= 0 ? fitness : 0;
+}
+
+bool World::look(const Polygon &fieldOfVision, double mouseY, Item &seen) const
+{
+    // items are sorted by spawn order, so the first one of the lowest kind is seen
+    const Item *best = nullptr;
+    for(const Item &item : items) {
+        if((!best || item.kind < best->kind) && intersects(fieldOfVision, item.shape)) {
+            best = &item;
+        }
+    }
+
+    if(!best || best->kind > Item::Bound) {
+        // bounds follow the mice, their position is reported next to the mouse
+        double minX = fieldOfVision.minX();
+        double maxX = fieldOfVision.maxX();
+        for(double x : {-boundX, boundX}) {
+            if(maxX >= x - boundW/2 && minX <= x + boundW/2) {
+                seen.kind = Item::Bound;
+                seen.x = x;
+                seen.y = mouseY;
+                return true;
+            }
+        }
+    }
+
+    if(!best) {
+        return false;
+    }
+    seen = *best;
+    return true;
+}
+
+void World::buildGrid()
+{
+    gridChanged = false;
+    itemStamp.assign(items.size(), 0);
+    rayStamp = 0;
+
+    if(items.empty()) {
+        gridColumns = 0;
+        gridRows = 0;
+        return;
+    }
+
+    double left = items[0].shape.minX();
+    double right = items[0].shape.maxX();
+    double top = items[0].shape.minY();
+    double bottom = items[0].shape.maxY();
+    for(const Item &item : items) {
+        left = std::min(left, item.shape.minX());
+        right = std::max(right, item.shape.maxX());
+        top = std::min(top, item.shape.minY());
+        bottom = std::max(bottom, item.shape.maxY());
+    }
+    gridLeft = left;
+    gridTop = top;
+    gridColumns = int((right - left) / cellSize) + 1;
+    gridRows = int((bottom - top) / cellSize) + 1;
+
+    // cells covered by the bounding box of every item, counted first and then filled
+    auto cells = [this](const Item &item, int &c0, int &c1, int &r0, int &r1) {
+        c0 = int((item.shape.minX() - gridLeft) / cellSize);
+        c1 = std::min(int((item.shape.maxX() - gridLeft) / cellSize), gridColumns - 1);
+        r0 = int((item.shape.minY() - gridTop) / cellSize);
+        r1 = std::min(int((item.shape.maxY() - gridTop) / cellSize), gridRows - 1);
+    };
+
+    gridStart.assign(size_t(gridColumns) * gridRows + 1, 0);
+    for(const Item &item : items) {
+        int c0, c1, r0, r1;
+        cells(item, c0, c1, r0, r1);
+        for(int r = r0; r <= r1; r++) {
+            for(int c = c0; c <= c1; c++) {
+                gridStart[r * gridColumns + c + 1]++;
+            }
+        }
+    }
+    for(size_t c = 1; c < gridStart.size(); c++) {
+        gridStart[c] += gridStart[c - 1];
+    }
+
+    gridItems.resize(gridStart.back());
+    std::vector<int> fill(gridStart.begin(), gridStart.end() - 1);
+    for(size_t i = 0; i < items.size(); i++) {
+        int c0, c1, r0, r1;
+        cells(items[i], c0, c1, r0, r1);
+        for(int r = r0; r <= r1; r++) {
+            for(int c = c0; c <= c1; c++) {
+                gridItems[fill[r * gridColumns + c]++] = int(i);
+            }
+        }
+    }
+}
+
+double World::castRay(double x, double y, double dx, double dy, double range, int &kind)
+{
+    double best = range;
+    kind = -1;
+
+    // water bounds are vertical strips, the ray hits the near side of one
+    for(double center : {-boundX, boundX}) {
+        double near = x < center ? center - boundW/2 : center + boundW/2;
+        double t = std::abs(x - center) <= boundW/2 ? 0 : (dx != 0 ? (near - x) / dx : -1);
+        if(t >= 0 && t < best) {
+            best = t;
+            kind = Item::Bound;
+        }
+    }
+
+    if(gridColumns == 0) {
+        return best;
+    }
+
+    // clip the ray to the grid
+    const double inf = std::numeric_limits<double>::infinity();
+    double right = gridLeft + gridColumns * cellSize;
+    double bottom = gridTop + gridRows * cellSize;
+    double enter = 0;
+    double exit = best;
+    if(dx != 0) {
+        double t0 = (gridLeft - x) / dx;
+        double t1 = (right - x) / dx;
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    } else if(x < gridLeft || x >= right) {
+        return best;
+    }
+    if(dy != 0) {
+        double t0 = (gridTop - y) / dy;
+        double t1 = (bottom - y) / dy;
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    } else if(y < gridTop || y >= bottom) {
+        return best;
+    }
+    if(enter > exit) {
+        return best;
+    }
+
+    // cell of the entry point and the distances to the next column and row (Amanatides-Woo)
+    int column = std::min(std::max(int((x + enter * dx - gridLeft) / cellSize), 0), gridColumns - 1);
+    int row = std::min(std::max(int((y + enter * dy - gridTop) / cellSize), 0), gridRows - 1);
+    int stepColumn = dx > 0 ? 1 : -1;
+    int stepRow = dy > 0 ? 1 : -1;
+    double nextColumn = dx != 0 ? (gridLeft + (column + (dx > 0)) * cellSize - x) / dx : inf;
+    double nextRow = dy != 0 ? (gridTop + (row + (dy > 0)) * cellSize - y) / dy : inf;
+    double deltaColumn = dx != 0 ? cellSize / std::abs(dx) : inf;
+    double deltaRow = dy != 0 ? cellSize / std::abs(dy) : inf;
+
+    if(++rayStamp == 0) {
+        std::fill(itemStamp.begin(), itemStamp.end(), 0);
+        rayStamp = 1;
+    }
+
+    // items of a cell can't be hit before the ray enters the cell
+    while(enter < best) {
+        int cell = row * gridColumns + column;
+        for(int k = gridStart[cell]; k < gridStart[cell + 1]; k++) {
+            int i = gridItems[k];
+            if(itemStamp[i] == rayStamp) {
+                continue;
+            }
+            itemStamp[i] = rayStamp;
+
+            double t = rayDistance(items[i].shape, x, y, dx, dy, best);
+            if(t < best) {
+                best = t;
+                kind = items[i].kind;
+            }
+        }
+
+        if(nextColumn < nextRow) {
+            column += stepColumn;
+            enter = nextColumn;
+            nextColumn += deltaColumn;
+            if(column < 0 || column >= gridColumns) {
+                break;
+            }
+        } else {
+            row += stepRow;
+            enter = nextRow;
+            nextRow += deltaRow;
+            if(row < 0 || row >= gridRows) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+void World::spawnAreas()
+{
+    double topY = startY;
+    for(size_t slot = 0; slot < numOfAlive; slot++) {
+        topY = std::min(topY, mice.y[slot]);
+    }
+
+    // areas are materialized before any mouse can see them
+    const int areaH = Track::areaHeight;
+    while(areaTop(nextArea) + areaH > topY - 2 * areaH) {
+        for(const TrackItem &trackItem : track->area(nextArea)) {
+            Item item;
+            item.x = trackItem.x;
+            item.y = areaTop(nextArea) + trackItem.offset;
+
+            if(trackItem.kind == TrackItem::Trap) {
+                item.kind = Item::Trap;
+                item.shape = rectangle(-20, -30, 45, 75, item.x, item.y, trackItem.rotation);
+            } else if(trackItem.kind == TrackItem::Cheese) {
+                item.kind = Item::Cheese;
+                item.shape = rectangle(-13, -13, 26, 26, item.x, item.y, trackItem.rotation);
+            } else {
+                item.kind = Item::Pool;
+                item.shape = ellipse(-trackItem.width/2, -trackItem.height/2,
+                                     trackItem.width, trackItem.height,
+                                     item.x, item.y, trackItem.rotation);
+            }
+            items.push_back(item);
+            gridChanged = true;
+        }
+        nextArea++;
+    }
+}
+
+void World::deleteItems()
+{
+    double limit = catY + 500;
+    auto end = std::remove_if(items.begin(), items.end(),
+                              [limit](const Item &item){ return item.y > limit; });
+    if(end != items.end()) {
+        items.erase(end, items.end());
+        gridChanged = true;
+    }
+}
@@ -0,0 +1,241 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <memory>
+#include <vector>
+
+#include "geometry.h"
+#include "track.h"
+
+// Outcome of the episode of one mouse
+struct EpisodeResult
+{
+    double fitness;
+    int termination;    // World::Termination
+    int ticks;          // how long the mouse was alive
+};
+
+// Combines the results of several episodes of one genome. Fitness is the mean, the minimum
+// or a quantile of the episodes, termination is that of the worst episode and ticks are summed.
+struct Aggregation
+{
+    enum Kind { Mean, Min, Quantile };
+
+    Aggregation(Kind kind = Mean, double quantile = 0.25);
+
+    Kind kind;
+    double quantile;
+
+    EpisodeResult combine(const EpisodeResult *episodes, size_t n) const;
+};
+
+// Inputs of the networks, the same for all worlds of a run.
+// Legacy: position, heading and the first item in three fields of vision, in scene coordinates.
+// Rays: rays evenly spread over the field of view around the heading, each reports the distance
+// to the first item or water bound it hits (1 - nothing within range) and the kind of it.
+// Egocentric: heading, distances to the cat and both water bounds, and the distance and bearing
+// of the nearest cheese, trap and pool, all relative to the mouse and scaled to [-1, 1].
+struct Sensors
+{
+    enum Encoding { Legacy, Rays, Egocentric };
+
+    Sensors();
+
+    Encoding encoding;
+    int rays;
+    double fieldOfView;     // degrees
+    double range;           // of the rays, distances of the egocentric sensors are divided by it
+
+    int numInputs() const;
+
+    static const char *encodingName(Encoding encoding);
+};
+
+// Simulation of the game without a scene. It is run headless by the Evaluator
+// and VecEnv, and Game only draws its state, so many worlds can run in parallel.
+//
+// Items stay at their course coordinates and the cat moves instead of
+// scrolling everything else, observations are given in scene coordinates
+// (relative to the cat) as the networks always saw them.
+class World
+{
+public:
+    // Rules for ending episodes of mice that can't do anything useful anymore, 0 disables a rule
+    struct Limits
+    {
+        Limits();
+
+        int idleTicks;      // no forward progress for this many ticks
+        int tickBudget;     // maximum length of an episode
+        double cutoff;      // fitness below which a genome is dropped, needs tickBudget
+    };
+
+    World(std::shared_ptr<const Track> track, size_t numMice, const Limits &limits = Limits());
+
+    // Keys pressed by a mouse
+    enum Action { Forward = 1, Left = 2, Backward = 4, Right = 8 };
+
+    // Why the episode of a mouse ended
+    enum Termination { Running, Caught, Trapped, Idle, Hopeless, Budget };
+    static const char *terminationName(int termination);
+
+    // Inputs of every mouse depend on the sensors, which are set before any world is created
+    static int numInputs;
+    static const int numOutputs = 4;
+
+    static const Sensors &sensors();
+    static void setSensors(const Sensors &sensors);
+
+    // Keys pressed for the given network outputs
+    static unsigned char decide(const double *outputs);
+
+    // Writes numInputs values for every alive mouse, rows of dead mice are not touched.
+    // Sensing also updates advanceBonus from the legacy fields of vision, whatever the
+    // encoding: cheese ahead or an obstacle on the side is a bonus, an obstacle ahead
+    // is a penalty.
+    void observe(double *inputs);
+
+    // Moves all alive mice with the given keys (one Action mask per mouse),
+    // then kills mice caught by the cat or trapped and advances the course
+    void step(const unsigned char *actions);
+
+    size_t numMice() const;
+    size_t numAlive() const;
+    bool finished() const;
+    int ticks() const;
+
+    // Alive mice are kept compact, aliveMouse(0) ... aliveMouse(numAlive() - 1) are alive
+    int aliveMouse(size_t k) const;
+
+    bool alive(size_t i) const;
+    double fitness(size_t i) const;     // fitness at the moment of death
+    EpisodeResult result(size_t i) const;
+
+    // Position of a mouse in course coordinates, heading in degrees
+    double mouseX(size_t i) const;
+    double mouseY(size_t i) const;
+    double heading(size_t i) const;
+
+    double catPosition() const;
+
+    // Areas of the track are spawned in order, items of area n are at areaTop(n) + offset
+    int spawnedAreas() const;
+    static double areaTop(int n);
+
+private:
+    // State of all mice, one array per field. Slots [0, numOfAlive) hold alive mice,
+    // mouse[slot] is the index of the mouse in the slot and slotOf[i] the slot of mouse i.
+    struct MiceState
+    {
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> heading;
+        std::vector<double> speed;
+        std::vector<double> traveled;
+        std::vector<double> rotated;
+        std::vector<double> fitness;
+        std::vector<double> bestY;          // farthest point reached
+        std::vector<int> lastProgress;      // tick of the last forward progress
+        std::vector<int> endTick;
+        std::vector<unsigned char> termination;
+        std::vector<int> advanceBonus;
+        std::vector<unsigned char> inWater;
+        std::vector<unsigned char> alive;
+        std::vector<unsigned char> actions;
+        std::vector<int> mouse;
+        std::vector<int> slotOf;
+
+        // results of collisions in the current step
+        std::vector<int> bonusDelta;
+        std::vector<unsigned char> ateCheese;
+
+        void resize(size_t n);
+        void swap(size_t a, size_t b);
+    };
+
+    struct Item
+    {
+        // order in which items are stacked in the scene (Qt::AscendingOrder)
+        enum Kind { Pool, Bound, Trap, Cheese };
+
+        Kind kind;
+        double x;
+        double y;
+        Polygon shape;
+    };
+
+    static Sensors sensorConfig;
+
+    std::shared_ptr<const Track> track;
+    Limits limits;
+    MiceState mice;
+    std::vector<Item> items;
+
+    // Uniform grid over the items for the rays, rebuilt when items are spawned or deleted.
+    // Items overlapping cell c are gridItems[gridStart[c] .. gridStart[c + 1]).
+    double gridLeft;
+    double gridTop;
+    int gridColumns;
+    int gridRows;
+    std::vector<int> gridStart;
+    std::vector<int> gridItems;
+    bool gridChanged;
+
+    // items already tested by the current ray have its stamp
+    std::vector<unsigned> itemStamp;
+    unsigned rayStamp;
+
+    // Nearest cheese, trap and pool of every alive mouse for the egocentric sensors,
+    // squared distance and position, one row per kind
+    std::vector<double> nearestDistance[3];
+    std::vector<double> nearestX[3];
+    std::vector<double> nearestY[3];
+
+    double catY;
+    int nextArea;
+    size_t numOfAlive;
+    int tick;
+
+    void spawnAreas();
+    void deleteItems();
+
+    // Collisions of all alive mice with items
+    void collide();
+
+    // Movement, rotation and energy consumption of all alive mice
+    void move();
+
+    // Ends episodes of dead mice and mice stopped by the limits,
+    // calculates their fitness and moves them out of the alive slots
+    void removeDead();
+
+    double calcFitness(size_t slot) const;
+
+    // The most fitness a mouse can have at the end of the tick budget
+    double fitnessUpperBound(size_t slot) const;
+
+    // Finds the item seen first in the field of vision, false if there is none
+    bool look(const Polygon &fieldOfVision, double mouseY, Item &seen) const;
+
+    void observeLegacy(double *inputs);
+    void observeRays(double *inputs);
+    void observeEgocentric(double *inputs);
+
+    // Items seen in the fields of vision in front, on the left and on the right,
+    // kinds[f] is the Item::Kind seen or -1
+    void lookAround(size_t slot, Item seen[3], int kinds[3]) const;
+
+    // Advance bonus for the kinds seen in front, on the left and on the right (-1 - none)
+    void addSightBonus(size_t slot, const int kinds[3]);
+
+    // Advance bonus of every alive mouse
+    void addSightBonus();
+
+    void buildGrid();
+
+    // Walks the cells of the grid along the ray (DDA) and returns the distance to the first
+    // item or water bound it hits, range if there is none. kind is the Item::Kind hit or -1.
+    double castRay(double x, double y, double dx, double dy, double range, int &kind);
+};
+
+#endif // WORLD_H
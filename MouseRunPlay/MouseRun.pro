@@ -31,14 +31,29 @@ SOURCES += \
     cheese.cpp \
     mousetrap.cpp \
     cat.cpp \
-    waterpool.cpp
+    waterpool.cpp \
+    aigame.cpp \
+    ../MouseRun/track.cpp \
+    ../MouseRun/geometry.cpp \
+    ../MouseRun/world.cpp \
+    ../MouseRun/network.cpp \
+    ../MouseRun/sprites.cpp
 HEADERS += \
     game.h \
     player.h \
     cheese.h \
     mousetrap.h \
     cat.h \
-    waterpool.h
+    waterpool.h \
+    aigame.h \
+    ../MouseRun/track.h \
+    ../MouseRun/geometry.h \
+    ../MouseRun/world.h \
+    ../MouseRun/network.h \
+    ../MouseRun/sprites.h
+
+# the champion mode runs the simulation and networks of MouseRun
+INCLUDEPATH += ../MouseRun
 
 FORMS +=
 
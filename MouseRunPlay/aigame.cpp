@@ -0,0 +1,181 @@
+#include "aigame.h"
+
+#include "cheese.h"
+#include "mousetrap.h"
+#include "waterpool.h"
+#include <QDebug>
+#include <algorithm>
+
+AiGame::AiGame(std::unique_ptr<Network> network, unsigned seed)
+    : player{new Player(false)},
+      network{std::move(network)},
+      track{std::make_shared<Track>(seed)},
+      world(track, 1),
+      drawnAreas{0},
+      inputs(World::numInputs),
+      outputs(World::numOutputs),
+      values(this->network->size()),
+      state(this->network->stateSize(), 0),
+      action{0},
+      latencySum{0},
+      latencyMax{0},
+      latencyFrames{0}
+{
+    // Create the scene
+    int width = 600;
+    int height = 800;
+
+    scene = new QGraphicsScene(this);
+    // World finds the collisions, so the scene doesn't index items that move every tick
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    setAlignment(Qt::AlignCenter);
+
+    setFixedSize(width, height);
+    scene->setSceneRect(-300, -300, width, height);
+    setScene(scene);
+
+    // Turn off the scrollbars
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    setBackgroundBrush(QBrush(QColor(55,205,55)));
+
+    // the counter stays in the corner of the window
+    latencyLabel = new QLabel(this);
+    latencyLabel->setStyleSheet("QLabel { background: rgba(0, 0, 0, 120); color: white; padding: 4px; }");
+    latencyLabel->move(5, 5);
+
+    player->setPos(world.mouseX(0), world.mouseY(0));
+    scene->addItem(player);
+
+    cat = new Cat();
+    cat->setPos(0, world.catPosition());
+    scene->addItem(cat);
+
+    // Setup left and right bound
+    boundW = 500;
+    leftBound  = new WaterBound(1500, boundW);
+    rightBound = new WaterBound(1500, boundW);
+
+    leftBound->setPos(-boundW, -300);
+    rightBound->setPos(boundW, -300);
+
+    scene->addItem(leftBound);
+    scene->addItem(rightBound);
+
+    spawnObjects();
+
+    connect(&updateTimer, SIGNAL(timeout()), this, SLOT(update()));
+    updateTimer.start(15);
+
+    move(0,0);
+    show();
+}
+
+void AiGame::makeDecision()
+{
+    // the same pipeline as Game::makeDecisions in MouseRun, without allocations
+    inferenceTimer.start();
+    world.observe(inputs.data());
+    network->evaluate(inputs.data(), outputs.data(), values.data(), state.data());
+    action = World::decide(outputs.data());
+    showLatency(inferenceTimer.nsecsElapsed());
+}
+
+void AiGame::showLatency(qint64 nsecs)
+{
+    latencySum += nsecs;
+    latencyMax = std::max(latencyMax, nsecs);
+    latencyFrames++;
+
+    // the text is only updated every 30 frames, about twice a second
+    if(latencyFrames < 30) {
+        return;
+    }
+    latencyLabel->setText(QString("Inference: %1 us avg, %2 us max")
+                          .arg(latencySum / 1000.0 / latencyFrames, 0, 'f', 2)
+                          .arg(latencyMax / 1000.0, 0, 'f', 2));
+    latencyLabel->adjustSize();
+    latencySum = 0;
+    latencyMax = 0;
+    latencyFrames = 0;
+}
+
+void AiGame::update()
+{
+    makeDecision();
+    world.step(&action);
+
+    if(world.finished()){
+        updateTimer.stop();
+        EpisodeResult result = world.result(0);
+        qDebug() << "Fitness:" << result.fitness << "Ticks:" << result.ticks
+                 << "End:" << World::terminationName(result.termination);
+        latencyLabel->setText(latencyLabel->text() + QString("\nFitness: %1 (%2)")
+                              .arg(result.fitness).arg(World::terminationName(result.termination)));
+        latencyLabel->adjustSize();
+        return;
+    }
+
+    player->setPos(world.mouseX(0), world.mouseY(0));
+    player->setRotation(world.heading(0));
+
+    double p = world.mouseY(0);
+    if (leftBound->pos().y() > p + 600) {
+        leftBound->setPos(leftBound->pos().x(), p);
+        rightBound->setPos(rightBound->pos().x(), p);
+    }
+
+    // the cat chases the mouse
+    cat->setPos(0, world.catPosition());
+
+    spawnObjects();
+    setSceneRect(-300, p - 400, 600, 800);
+    deleteObjects();
+}
+
+void AiGame::spawnObjectsInArea(int area)
+{
+    for(const TrackItem &trackItem : track->area(area)) {
+
+        QGraphicsItem *item;
+
+        if (trackItem.kind == TrackItem::Trap){
+            item = new MouseTrap();
+
+        } else if (trackItem.kind == TrackItem::Cheese){
+            item = new Cheese();
+
+        } else{
+            item = new WaterPool(trackItem.height, trackItem.width);
+        }
+
+        item->setRotation(trackItem.rotation);
+        item->setPos(trackItem.x, World::areaTop(area) + trackItem.offset);
+
+        scene->addItem(item);
+        items.push_back(item);
+    }
+}
+
+void AiGame::spawnObjects()
+{
+    // draw the areas spawned by the world
+    while(drawnAreas < world.spawnedAreas()){
+        spawnObjectsInArea(drawnAreas++);
+    }
+}
+
+void AiGame::deleteObjects()
+{
+    // the same rule as in World, items far behind the cat are gone
+    for(auto it = items.begin(); it != items.end(); ){
+        if((*it)->pos().y() > world.catPosition() + 500){
+            scene->removeItem(*it);
+            delete *it;
+            it = items.erase(it);
+        }else{
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef AIGAME_H
+#define AIGAME_H
+
+#include <QGraphicsView>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QTimer>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "player.h"
+#include "cat.h"
+#include "network.h"
+#include "track.h"
+#include "world.h"
+
+// The mouse is driven by a champion network exported by MouseRun (--champion).
+// The game is simulated by MouseRun's World with the same sensors and decisions
+// as in training, the scene only follows the world's state.
+class AiGame : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    AiGame(std::unique_ptr<Network> network, unsigned seed);
+
+private:
+    QGraphicsScene* scene;
+    Player* player;
+    Cat* cat;
+
+    std::unique_ptr<Network> network;
+    std::shared_ptr<const Track> track;
+    World world;
+    int drawnAreas;
+
+    // buffers of the network, allocated once
+    std::vector<double> inputs;
+    std::vector<double> outputs;
+    std::vector<double> values;
+    std::vector<double> state;      // of recurrent connections, the game is one episode
+    unsigned char action;
+
+    // inference latency, shown every few frames
+    QElapsedTimer inferenceTimer;
+    QLabel* latencyLabel;
+    qint64 latencySum;
+    qint64 latencyMax;
+    int latencyFrames;
+
+    QTimer updateTimer;
+
+    QGraphicsItem *leftBound;
+    QGraphicsItem *rightBound;
+    qreal boundW;
+
+    // items of the course in spawn order
+    std::deque<QGraphicsItem*> items;
+
+    void spawnObjectsInArea(int area);
+    void spawnObjects();
+    void deleteObjects();
+    void makeDecision();
+    void showLatency(qint64 nsecs);
+
+private slots:
+    void update();
+
+};
+
+#endif // AIGAME_H
@@ -1,10 +1,12 @@
 #include "cat.h"
+#include "sprites.h"
 
 #include <QPainter>
 
 Cat::Cat() : speed(5)
 {
     setZValue(5);
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 QRectF Cat::boundingRect() const
@@ -22,5 +24,5 @@ QPainterPath Cat::shape() const
 void Cat::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 {
     painter->setRenderHint(QPainter::Antialiasing);
-    painter->drawPixmap(boundingRect().toRect(), QPixmap(":/img/cat.png"));
+    painter->drawPixmap(boundingRect().toRect(), Sprites::cat());
 }
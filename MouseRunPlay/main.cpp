@@ -1,11 +1,43 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
 
 #include "game.h"
+#include "aigame.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Play MouseRun with the keyboard or watch a trained champion.");
+    parser.addHelpOption();
+    QCommandLineOption championOption("champion",
+                                      "Let the network of a champion file written by MouseRun drive the mouse.",
+                                      "file");
+    QCommandLineOption seedOption("seed",
+                                  "Seed of the champion's track, random by default.",
+                                  "seed");
+    parser.addOption(championOption);
+    parser.addOption(seedOption);
+    parser.process(a);
+
+    if(parser.isSet(championOption)){
+        std::unique_ptr<Network> network(Network::load(parser.value(championOption)));
+        if(!network || network->numOutputs() != World::numOutputs){
+            qCritical("Not a champion network: %s", qPrintable(parser.value(championOption)));
+            return 1;
+        }
+
+        // the champion sees the world through the sensors of its training run
+        World::setSensors(network->sensors());
+
+        unsigned seed = parser.isSet(seedOption) ? parser.value(seedOption).toUInt()
+                                                 : QRandomGenerator::global()->generate();
+        AiGame game(std::move(network), seed);
+        return a.exec();
+    }
+
     Game game;
 
     return a.exec();
@@ -1,10 +1,10 @@
 #include "player.h"
+#include "sprites.h"
 #include "cheese.h"
 #include "mousetrap.h"
 #include "waterpool.h"
 #include "cat.h"
 #include <QPainter>
-#include <QRandomGenerator>
 #include <QGraphicsScene>
 #include <QKeyEvent>
 #include <QTimer>
@@ -14,20 +14,14 @@ const int Player::maxSpeed = 6;
 const qreal Player::turningAngle = 0.5;
 const qreal Player::consumption = 0.01;
 
-Player::Player()
+Player::Player(bool keyboard)
     :
       angle{0},
       speed{5},
       alive{true},
       inWater{false},
-      color{QRandomGenerator::global()->bounded(256),
-            QRandomGenerator::global()->bounded(256),
-            QRandomGenerator::global()->bounded(256)
-            },
-      color2{QRandomGenerator::global()->bounded(256),
-             QRandomGenerator::global()->bounded(256),
-             QRandomGenerator::global()->bounded(256)
-             }
+      color{Sprites::randomColor()},
+      color2{Sprites::randomColor()}
 {
     keysDown['w'] = false;
     keysDown['a'] = false;
@@ -35,8 +29,12 @@ Player::Player()
     keysDown['d'] = false;
 
     setZValue(2);
+    sprite = Sprites::mouse(color, color2);
 
     setPos(0, 0);
+    if(!keyboard){
+        return;
+    }
     setFlag(QGraphicsItem::ItemIsFocusable);
     setFocus();
 
@@ -50,9 +48,7 @@ Player::Player()
 // Taken from the CollidingMice example
 QRectF Player::boundingRect() const
 {
-    qreal adjust = 0.5;
-    return QRectF(-18 - adjust, -22 - adjust,
-                  36 + adjust, 60 + adjust);
+    return Sprites::mouseRect();
 }
 
 // Taken from the CollidingMice example
@@ -63,44 +59,11 @@ QPainterPath Player::shape() const
     return path;
 }
 
-// Taken from the CollidingMice example and slightly modified
 void Player::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 {
-    painter->setRenderHint(QPainter::Antialiasing);
-
-//    painter->drawRect(fieldOfVisionForward());
-//    painter->drawRect(fieldOfVisionLeft());
-//    painter->drawRect(fieldOfVisionRight());
-
-    // Body
-    painter->setBrush(color);
-    painter->drawEllipse(-10, -20, 20, 40);
-
-    // Eyes
-    painter->setBrush(Qt::white);
-    painter->drawEllipse(-10, -17, 8, 8);
-    painter->drawEllipse(2, -17, 8, 8);
-
-    // Nose
-    painter->setBrush(Qt::black);
-    painter->drawEllipse(QRectF(-2, -22, 4, 4));
-
-    // Pupils
-    painter->drawEllipse(QRectF(-8.0, -17, 4, 4));
-    painter->drawEllipse(QRectF(4.0, -17, 4, 4));
-
-    // Ears
-    painter->setBrush(color2);
-    painter->drawEllipse(-17, -12, 16, 16);
-    painter->drawEllipse(1, -12, 16, 16);
-
-    // Tail
-    QPainterPath path(QPointF(0, 20));
-    path.cubicTo(-5, 22, -5, 22, 0, 25);
-    path.cubicTo(5, 27, 5, 32, 0, 30);
-    path.cubicTo(-5, 32, -5, 42, 0, 35);
-    painter->setBrush(Qt::NoBrush);
-    painter->drawPath(path);
+    // the sprite is rendered once, only its transformation changes between frames
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(boundingRect(), sprite, QRectF(sprite.rect()));
 }
 
 void Player::keyPressEvent(QKeyEvent *event)
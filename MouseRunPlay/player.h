@@ -3,13 +3,15 @@
 
 #include <QObject>
 #include <QGraphicsItem>
+#include <QPixmap>
 #include <vector>
 
 class Player : public QObject, public QGraphicsItem
 {
     Q_OBJECT
 public:
-    Player();
+    // A player that isn't controlled by the keyboard is only a drawing moved by its owner
+    explicit Player(bool keyboard = true);
 
     // Methods used for collision detection and drawing, inherited from QGraphicsItem
     QRectF boundingRect() const override;
@@ -40,6 +42,7 @@ private:
 
     QColor color;   // Color of the mouse body
     QColor color2;  // Color of the mouse ears
+    QPixmap sprite; // Mouse drawn with both colors, shared by mice of the same colors
 
     void move();
 